@@ -0,0 +1,784 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_bench.c
+// Benchmarks of the bitset functions across sizes, densities, alignments 
+// and kernel backends. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <time.h>
+#include "bitset.h"
+#include "bitset_kernel.h"
+#include "bitset_atomic.h"
+#include "bitset_batch.h"
+#include "bitset_fixed.h"
+#include "bitset_parallel.h"
+#include "bitset_rank.h"
+#include "bitset_roaring.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define BENCH_TSC 1
+#endif
+
+#define SIZES 7                 // 2^6 to 2^30 bits, 16 times apart
+#define DENSITIES 3
+#define ALIGNS 3
+#define ELEMS 1024              // calls made per run of a per-element case
+#define MANY 4                  // operands of the many-way cases
+#define BATCH_SETS 64
+#define STR_MAX ((size_t)1 << 26)       // longest string case, in bits
+#define BATCH_MAX ((size_t)1 << 20)     // longest batch case, in bits
+
+// Case flags. A kernel case runs once per kernel backend, an aligned case 
+// once per alignment, and a dense case once per density. 
+#define KERNEL 1
+#define ALIGNED 2
+#define DENSE 4
+#define ELEM 8              // counts calls rather than words
+
+// Average number of random words ANDed together for each density. 
+static const int density_ands[DENSITIES] = { 1, 3, 8 };
+static const char *density_names[DENSITIES] = { "1/2", "1/8", "1/256" };
+
+// Byte offsets from a 64-byte boundary the bits are stored at. 
+static const size_t align_offsets[ALIGNS] = { 0, 8, 32 };
+
+// The benchmark state, set up once per size, density and alignment. 
+typedef struct bench_ctx_t {
+    size_t n;               // length of every bitset
+    bitset a, b, c, d, z;   // random operands, and z with every bit at 0
+    uint64_t *mem[5];       // memory of the operands
+    uint64_t *orig;         // the words of a, restored before every case
+    const bitset *srcs[MANY];
+    size_t idx[ELEMS];      // random indices below n
+    char *str;              // bit string of a, for the string cases
+    uint32_t *out;          // output of bitset_to_indices
+    bitset_pool *pool;      // threads of the parallel backend
+    bitset_rank_index rank;
+    bitset_roaring ra, rb;
+    bitset_batch batch;
+    bitset_atomic atomic;
+    volatile size_t sink;   // results, kept so calls are not optimised out
+} bench_ctx;
+
+// The benchmark case type. 
+typedef struct bench_case_t {
+    const char *name;
+    int flags;
+    size_t operands;        // bitsets read or written per call
+    size_t max_bits;        // longest bitset to run on, or 0 for any
+    int (*prep)(bench_ctx *c);      // sets up the case, or NULL
+    size_t (*run)(bench_ctx *c);    // runs the case, returning calls made
+    size_t (*run_par)(bench_ctx *c);    // runs on the pool, or NULL
+    void (*done)(bench_ctx *c);     // cleans up the case, or NULL
+} bench_case;
+
+// The command line options. 
+typedef struct bench_opts_t {
+    size_t min_bits, max_bits;
+    double min_ns;          // time to run each case for
+    const char *filter;     // runs only cases containing this, or NULL
+    const char *json;       // file to write results to, or NULL
+    size_t threads;
+} bench_opts;
+
+static uint64_t rng = 88172645463325252ULL;
+
+// Returns a random word. 
+//
+// RET: 
+// The next word of a xorshift generator. 
+static uint64_t rnd(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+// Returns the current time in nanoseconds. 
+//
+// RET: 
+// The time of a monotonic clock. 
+static double now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// Returns the time stamp counter, or 0 if there is none. 
+//
+// RET: 
+// The number of cycles counted. 
+static uint64_t cycles(void) {
+#ifdef BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Fills a bitset with random bits of a density. 
+//
+// PARAMS: 
+// b    - the bitset to fill
+// ands - the number of random words ANDed into each word
+static void fill(bitset *b, int ands) {
+    size_t nw = BITSET_WORDS(b->len);
+    for (size_t i = 0; i < nw; i++) {
+        uint64_t w = rnd();
+        for (int k = 1; k < ands; k++)
+            w &= rnd();
+        b->bits[i] = w;
+    }
+    if (b->len % BITSET_WORD_LEN != 0)
+        b->bits[nw - 1] &= UINT64_MAX >> (BITSET_WORD_LEN
+                - b->len % BITSET_WORD_LEN);
+}
+
+// Initialises an operand on memory at an offset from a 64-byte boundary. 
+//
+// PARAMS: 
+// b      - the operand to initialise
+// mem    - the memory of the operand
+// n      - the length of the operand
+// offset - the offset in bytes
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int operand(bitset *b, uint64_t **mem, size_t n, size_t offset) {
+    if (posix_memalign((void **)mem, 64, BITSET_WORDS(n) * 8 + 64) != 0)
+        return BITSET_ALLOC_ERR;
+    return bitset_init_buffer(b, (char *)*mem + offset, n);
+}
+
+// Frees the state of a benchmark. 
+//
+// PARAMS: 
+// c - the state to free
+static void teardown(bench_ctx *c) {
+    for (int i = 0; i < 5; i++) {
+        free(c->mem[i]);
+        c->mem[i] = NULL;
+    }
+    free(c->orig);
+    c->orig = NULL;
+}
+
+// Sets up the state of a benchmark. 
+//
+// PARAMS: 
+// c      - the state to set up
+// n      - the length of every bitset
+// ands   - the density of the operands, as in fill
+// offset - the offset of the operands from a 64-byte boundary
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int setup(bench_ctx *c, size_t n, int ands, size_t offset) {
+    bitset *ops[5] = { &c->a, &c->b, &c->c, &c->d, &c->z };
+    c->n = n;
+    for (int i = 0; i < 5; i++) {
+        if (operand(ops[i], &c->mem[i], n, offset) != BITSET_GOOD) {
+            teardown(c);
+            return BITSET_ALLOC_ERR;
+        }
+        if (i < 4)
+            fill(ops[i], (i < 2) ? ands : 1);
+    }
+    c->orig = malloc(BITSET_WORDS(n) * sizeof(uint64_t));
+    if (c->orig == NULL) {
+        teardown(c);
+        return BITSET_ALLOC_ERR;
+    }
+    memcpy(c->orig, c->a.bits, BITSET_WORDS(n) * sizeof(uint64_t));
+    c->srcs[0] = &c->a;
+    c->srcs[1] = &c->b;
+    c->srcs[2] = &c->c;
+    c->srcs[3] = &c->d;
+    for (size_t i = 0; i < ELEMS; i++)
+        c->idx[i] = rnd() % n;
+    return BITSET_GOOD;
+}
+
+// Defines a case making one call of a whole-bitset function. 
+#define BULK(name, call) \
+    static size_t name(bench_ctx *c) { \
+        call; \
+        return 1; \
+    }
+
+// Defines a case making ELEMS calls of a single-bit function. 
+#define EACH(name, call) \
+    static size_t name(bench_ctx *c) { \
+        for (size_t k = 0; k < ELEMS; k++) { \
+            size_t i = c->idx[k]; \
+            call; \
+        } \
+        return ELEMS; \
+    }
+
+BULK(run_true_len, c->sink += bitset_true_len(&c->a))
+BULK(run_all, c->sink += bitset_all(&c->a))
+BULK(run_any, c->sink += bitset_any(&c->z))
+BULK(run_intersects, c->sink += bitset_intersects(&c->a, &c->z))
+BULK(run_is_subset, c->sink += bitset_is_subset(&c->a, &c->a))
+BULK(run_and, bitset_and(&c->a, &c->b))
+BULK(run_or, bitset_or(&c->a, &c->b))
+BULK(run_xor, bitset_xor(&c->a, &c->b))
+BULK(run_andnot, bitset_andnot(&c->a, &c->b))
+BULK(run_and3, bitset_and3(&c->a, &c->b, &c->c))
+BULK(run_or3, bitset_or3(&c->a, &c->b, &c->c))
+BULK(run_xor3, bitset_xor3(&c->a, &c->b, &c->c))
+BULK(run_andnot3, bitset_andnot3(&c->a, &c->b, &c->c))
+BULK(run_and_many, bitset_and_many(&c->z, c->srcs, MANY))
+BULK(run_or_many, bitset_or_many(&c->z, c->srcs, MANY))
+BULK(run_xor_many, bitset_xor_many(&c->z, c->srcs, MANY))
+BULK(run_threshold_many, bitset_threshold_many(&c->z, c->srcs, MANY, 2))
+BULK(run_and_count, c->sink += bitset_and_count(&c->a, &c->b))
+BULK(run_or_count, c->sink += bitset_or_count(&c->a, &c->b))
+BULK(run_xor_count, c->sink += bitset_xor_count(&c->a, &c->b))
+BULK(run_andnot_count, c->sink += bitset_andnot_count(&c->a, &c->b))
+BULK(run_not, bitset_not(&c->a))
+BULK(run_lsh, bitset_lsh(&c->a, 3))
+BULK(run_rsh, bitset_rsh(&c->a, 3))
+BULK(run_lrot, bitset_lrot(&c->a, 3))
+BULK(run_rrot, bitset_rrot(&c->a, 3))
+BULK(run_reset, bitset_reset(&c->a))
+BULK(run_set_range, bitset_set_range(&c->a, 1, c->n - 2))
+BULK(run_clear_range, bitset_clear_range(&c->a, 1, c->n - 2))
+BULK(run_flip_range, bitset_flip_range(&c->a, 1, c->n - 2))
+BULK(run_count_range, c->sink += bitset_count_range(&c->a, 1, c->n - 2))
+BULK(run_any_range, c->sink += bitset_any_range(&c->z, 1, c->n - 2))
+BULK(run_to_indices, c->sink += bitset_to_indices(&c->a, c->out))
+BULK(run_to_bstr, bitset_to_bstr(&c->a, c->str))
+BULK(run_rank_init, bitset_rank_invalidate(&c->rank);
+        c->sink += bitset_rank(&c->rank, 0))
+BULK(run_roaring_init, bitset_roaring_free(&c->ra);
+        bitset_roaring_init_bitset(&c->ra, &c->a))
+BULK(run_roaring_to_bitset, bitset_roaring_to_bitset(&c->ra, &c->z))
+BULK(run_roaring_and, bitset_roaring_and(&c->ra, &c->rb))
+BULK(run_atomic_snapshot, bitset_atomic_snapshot(&c->atomic, &c->z))
+BULK(run_par_and, bitset_par_and(c->pool, &c->a, &c->b))
+BULK(run_par_or, bitset_par_or(c->pool, &c->a, &c->b))
+BULK(run_par_xor, bitset_par_xor(c->pool, &c->a, &c->b))
+BULK(run_par_not, bitset_par_not(c->pool, &c->a))
+BULK(run_par_true_len, c->sink += bitset_par_true_len(c->pool, &c->a))
+BULK(run_par_reset, bitset_par_reset(c->pool, &c->a))
+
+EACH(run_set_checked, bitset_set_checked(&c->a, i))
+EACH(run_clear_checked, bitset_clear_checked(&c->a, i))
+EACH(run_flip_checked, bitset_flip_checked(&c->a, i))
+EACH(run_test_checked, c->sink += bitset_test_checked(&c->a, i))
+EACH(run_set, bitset_set(&c->a, i))
+EACH(run_test, c->sink += bitset_test(&c->a, i))
+EACH(run_next_set, c->sink += bitset_next_set(&c->a, i))
+EACH(run_next_clear, c->sink += bitset_next_clear(&c->a, i))
+EACH(run_prev_set, c->sink += bitset_prev_set(&c->a, i))
+EACH(run_rank, c->sink += bitset_rank(&c->rank, i))
+EACH(run_roaring_test, c->sink += bitset_roaring_test(&c->ra, (uint32_t)i))
+EACH(run_atomic_set, bitset_atomic_set(&c->atomic, i))
+EACH(run_atomic_test_and_set,
+        c->sink += bitset_atomic_test_and_set(&c->atomic, i))
+EACH(run_cache_set_count, bitset_flip_checked(&c->a, i);
+        c->sink += bitset_true_len(&c->a))
+
+// Runs bitset_set_many on ELEMS random indices. 
+static size_t run_set_many(bench_ctx *c) {
+    bitset_set_many(&c->a, c->idx, ELEMS);
+    return ELEMS;
+}
+
+// Runs bitset_flip_many on ELEMS random indices. 
+static size_t run_flip_many(bench_ctx *c) {
+    bitset_flip_many(&c->a, c->idx, ELEMS);
+    return ELEMS;
+}
+
+// Runs bitset_select on ELEMS random ranks. 
+static size_t run_select(bench_ctx *c) {
+    size_t ones = bitset_true_len(&c->a);
+    for (size_t k = 0; ones > 0 && k < ELEMS; k++)
+        c->sink += bitset_select(&c->rank, c->idx[k] % ones);
+    return ELEMS;
+}
+
+// Visits a bit for bitset_foreach. 
+static _Bool visit(size_t i, void *ctx) {
+    *(size_t *)ctx += i;
+    return true;
+}
+
+// Visits every bit set to 1 with bitset_foreach. 
+static size_t run_foreach(bench_ctx *c) {
+    size_t sum = 0;
+    bitset_foreach(&c->a, visit, &sum);
+    c->sink += sum;
+    return 1;
+}
+
+// Walks every bit set to 1 with the inline iterator. 
+static size_t run_iter(bench_ctx *c) {
+    bitset_iter it;
+    size_t i;
+    bitset_iter_init(&it, &c->a);
+    while (bitset_iter_next(&it, &i))
+        c->sink += i;
+    return 1;
+}
+
+// Initialises and frees a bitset. 
+static size_t run_init(bench_ctx *c) {
+    bitset b;
+    if (bitset_init(&b, c->n) == BITSET_GOOD)
+        c->sink += b.bits[0];
+    bitset_free(&b);
+    return 1;
+}
+
+// Copies and frees a bitset. 
+static size_t run_copy(bench_ctx *c) {
+    bitset b;
+    if (bitset_copy(&b, &c->a) == BITSET_GOOD)
+        c->sink += b.bits[0];
+    bitset_free(&b);
+    return 1;
+}
+
+// Appends a bitset to a copy of itself. 
+static size_t run_append(bench_ctx *c) {
+    bitset b;
+    if (bitset_copy(&b, &c->a) == BITSET_GOOD)
+        bitset_append(&b, &c->a);
+    bitset_free(&b);
+    return 1;
+}
+
+// Appends ELEMS bits to a bitset, growing it one bit at a time. 
+static size_t run_push_back(bench_ctx *c) {
+    bitset b;
+    if (bitset_init(&b, 1) == BITSET_GOOD)
+        for (size_t k = 0; k < ELEMS; k++)
+            bitset_push_back(&b, c->idx[k] & 1);
+    bitset_free(&b);
+    return ELEMS;
+}
+
+// Initialises a bitset from the bit string of a, then frees it. 
+static size_t run_init_bstr(bench_ctx *c) {
+    bitset b;
+    if (bitset_init_bstr(&b, c->str, c->n) == BITSET_GOOD)
+        c->sink += b.bits[0];
+    bitset_free(&b);
+    return 1;
+}
+
+// Initialises a bitset from the bit string of a, read as 8-bit characters. 
+static size_t run_init_str(bench_ctx *c) {
+    bitset b;
+    if (bitset_init_str(&b, c->str, c->n / 8) == BITSET_GOOD)
+        c->sink += b.bits[0];
+    bitset_free(&b);
+    return 1;
+}
+
+// Runs the and and count operations of a fixed-size bitset ELEMS times. 
+static size_t run_fixed256(bench_ctx *c) {
+    bitset256 x = bitset256_zero(), y = bitset256_zero();
+    for (size_t k = 0; k < 4; k++) {
+        x.w[k] = c->a.bits[k % BITSET_WORDS(c->n)];
+        y.w[k] = c->b.bits[k % BITSET_WORDS(c->n)];
+    }
+    for (size_t k = 0; k < ELEMS; k++) {
+        x = bitset256_xor(bitset256_and(x, y), bitset256_lsh(y, k % 7));
+        c->sink += bitset256_count(x);
+    }
+    return ELEMS;
+}
+
+// Counts the AND of every bitset of a batch with a. 
+static size_t run_batch_and_count(bench_ctx *c) {
+    static size_t counts[BATCH_SETS];
+    bitset_batch_and_count(&c->batch, &c->a, counts);
+    c->sink += counts[0];
+    return 1;
+}
+
+// Allocates the string and index outputs. 
+static int prep_str(bench_ctx *c) {
+    c->str = malloc(c->n + 1);
+    if (c->str == NULL)
+        return BITSET_ALLOC_ERR;
+    return bitset_to_bstr(&c->a, c->str);
+}
+
+static int prep_out(bench_ctx *c) {
+    c->out = malloc((bitset_true_len(&c->a) + 1) * sizeof(uint32_t));
+    return (c->out == NULL) ? BITSET_ALLOC_ERR : BITSET_GOOD;
+}
+
+static int prep_rank(bench_ctx *c) {
+    return bitset_rank_init(&c->rank, &c->a);
+}
+
+static int prep_roaring(bench_ctx *c) {
+    int ret = bitset_roaring_init_bitset(&c->ra, &c->a);
+    if (ret == BITSET_GOOD)
+        ret = bitset_roaring_init_bitset(&c->rb, &c->b);
+    return ret;
+}
+
+static int prep_batch(bench_ctx *c) {
+    int ret = bitset_batch_init(&c->batch, BATCH_SETS, c->n,
+            BITSET_BATCH_COLUMNS);
+    for (size_t j = 0; ret == BITSET_GOOD && j < BATCH_SETS; j++)
+        ret = bitset_batch_load(&c->batch, j, (j % 2) ? &c->b : &c->c);
+    return ret;
+}
+
+static int prep_atomic(bench_ctx *c) {
+    return bitset_atomic_init(&c->atomic, c->n);
+}
+
+static int prep_cache(bench_ctx *c) {
+    return bitset_cache_enable(&c->a);
+}
+
+static void done_str(bench_ctx *c) {
+    free(c->str);
+    c->str = NULL;
+}
+
+static void done_out(bench_ctx *c) {
+    free(c->out);
+    c->out = NULL;
+}
+
+static void done_rank(bench_ctx *c) {
+    bitset_rank_free(&c->rank);
+}
+
+static void done_roaring(bench_ctx *c) {
+    bitset_roaring_free(&c->ra);
+    bitset_roaring_free(&c->rb);
+}
+
+static void done_batch(bench_ctx *c) {
+    bitset_batch_free(&c->batch);
+}
+
+static void done_atomic(bench_ctx *c) {
+    bitset_atomic_free(&c->atomic);
+}
+
+static void done_cache(bench_ctx *c) {
+    bitset_cache_disable(&c->a);
+}
+
+#define KA (KERNEL | ALIGNED)
+
+static const bench_case cases[] = {
+    { "bitset_init", 0, 1, 0, NULL, run_init, NULL, NULL },
+    { "bitset_init_bstr", 0, 9, STR_MAX, prep_str, run_init_bstr, NULL,
+        done_str },
+    { "bitset_init_str", 0, 2, STR_MAX, prep_str, run_init_str, NULL,
+        done_str },
+    { "bitset_to_bstr", 0, 9, STR_MAX, prep_str, run_to_bstr, NULL,
+        done_str },
+    { "bitset_copy", 0, 2, 0, NULL, run_copy, NULL, NULL },
+    { "bitset_append", 0, 5, 0, NULL, run_append, NULL, NULL },
+    { "bitset_push_back", ELEM, 0, 0, NULL, run_push_back, NULL, NULL },
+    { "bitset_set_checked", ELEM | DENSE, 0, 0, NULL, run_set_checked, NULL,
+        NULL },
+    { "bitset_clear_checked", ELEM, 0, 0, NULL, run_clear_checked, NULL,
+        NULL },
+    { "bitset_flip_checked", ELEM, 0, 0, NULL, run_flip_checked, NULL, NULL },
+    { "bitset_test_checked", ELEM, 0, 0, NULL, run_test_checked, NULL, NULL },
+    { "bitset_set", ELEM, 0, 0, NULL, run_set, NULL, NULL },
+    { "bitset_test", ELEM, 0, 0, NULL, run_test, NULL, NULL },
+    { "bitset_set_many", ELEM, 0, 0, NULL, run_set_many, NULL, NULL },
+    { "bitset_flip_many", ELEM, 0, 0, NULL, run_flip_many, NULL, NULL },
+    { "bitset_set_range", ALIGNED, 2, 0, NULL, run_set_range, NULL, NULL },
+    { "bitset_clear_range", ALIGNED, 2, 0, NULL, run_clear_range, NULL,
+        NULL },
+    { "bitset_flip_range", ALIGNED, 2, 0, NULL, run_flip_range, NULL, NULL },
+    { "bitset_count_range", KA, 1, 0, NULL, run_count_range, NULL, NULL },
+    { "bitset_any_range", KA, 1, 0, NULL, run_any_range, NULL, NULL },
+    { "bitset_next_set", ELEM | DENSE, 0, 0, NULL, run_next_set, NULL, NULL },
+    { "bitset_next_clear", ELEM | DENSE, 0, 0, NULL, run_next_clear, NULL,
+        NULL },
+    { "bitset_prev_set", ELEM | DENSE, 0, 0, NULL, run_prev_set, NULL, NULL },
+    { "bitset_foreach", DENSE, 1, 0, NULL, run_foreach, NULL, NULL },
+    { "bitset_iter", DENSE, 1, 0, NULL, run_iter, NULL, NULL },
+    { "bitset_to_indices", KERNEL | DENSE, 1, 0, prep_out, run_to_indices,
+        NULL, done_out },
+    { "bitset_true_len", KA, 1, 0, NULL, run_true_len, run_par_true_len,
+        NULL },
+    { "bitset_true_len (cached)", ELEM, 0, 0, prep_cache, run_cache_set_count,
+        NULL, done_cache },
+    { "bitset_all", KA, 1, 0, NULL, run_all, NULL, NULL },
+    { "bitset_any", KA, 1, 0, NULL, run_any, NULL, NULL },
+    { "bitset_intersects", KA, 2, 0, NULL, run_intersects, NULL, NULL },
+    { "bitset_is_subset", KA, 2, 0, NULL, run_is_subset, NULL, NULL },
+    { "bitset_and", KA, 3, 0, NULL, run_and, run_par_and, NULL },
+    { "bitset_or", KA, 3, 0, NULL, run_or, run_par_or, NULL },
+    { "bitset_xor", KA, 3, 0, NULL, run_xor, run_par_xor, NULL },
+    { "bitset_andnot", KA, 3, 0, NULL, run_andnot, NULL, NULL },
+    { "bitset_and3", KA, 3, 0, NULL, run_and3, NULL, NULL },
+    { "bitset_or3", KA, 3, 0, NULL, run_or3, NULL, NULL },
+    { "bitset_xor3", KA, 3, 0, NULL, run_xor3, NULL, NULL },
+    { "bitset_andnot3", KA, 3, 0, NULL, run_andnot3, NULL, NULL },
+    { "bitset_and_many", KA, MANY + 1, 0, NULL, run_and_many, NULL, NULL },
+    { "bitset_or_many", KA, MANY + 1, 0, NULL, run_or_many, NULL, NULL },
+    { "bitset_xor_many", KA, MANY + 1, 0, NULL, run_xor_many, NULL, NULL },
+    { "bitset_threshold_many", ALIGNED, MANY + 1, 0, NULL,
+        run_threshold_many, NULL, NULL },
+    { "bitset_and_count", KA, 2, 0, NULL, run_and_count, NULL, NULL },
+    { "bitset_or_count", KA, 2, 0, NULL, run_or_count, NULL, NULL },
+    { "bitset_xor_count", KA, 2, 0, NULL, run_xor_count, NULL, NULL },
+    { "bitset_andnot_count", KA, 2, 0, NULL, run_andnot_count, NULL, NULL },
+    { "bitset_not", KA, 2, 0, NULL, run_not, run_par_not, NULL },
+    { "bitset_lsh", ALIGNED, 2, 0, NULL, run_lsh, NULL, NULL },
+    { "bitset_rsh", ALIGNED, 2, 0, NULL, run_rsh, NULL, NULL },
+    { "bitset_lrot", ALIGNED, 2, 0, NULL, run_lrot, NULL, NULL },
+    { "bitset_rrot", ALIGNED, 2, 0, NULL, run_rrot, NULL, NULL },
+    { "bitset_reset", ALIGNED, 1, 0, NULL, run_reset, run_par_reset, NULL },
+    { "bitset_rank_init", DENSE, 1, 0, prep_rank, run_rank_init, NULL,
+        done_rank },
+    { "bitset_rank", ELEM | DENSE, 0, 0, prep_rank, run_rank, NULL,
+        done_rank },
+    { "bitset_select", ELEM | DENSE, 0, 0, prep_rank, run_select, NULL,
+        done_rank },
+    { "bitset_roaring_init_bitset", DENSE, 1, 0, prep_roaring,
+        run_roaring_init, NULL, done_roaring },
+    { "bitset_roaring_to_bitset", DENSE, 1, 0, prep_roaring,
+        run_roaring_to_bitset, NULL, done_roaring },
+    { "bitset_roaring_and", DENSE, 2, 0, prep_roaring, run_roaring_and, NULL,
+        done_roaring },
+    { "bitset_roaring_test", ELEM | DENSE, 0, 0, prep_roaring,
+        run_roaring_test, NULL, done_roaring },
+    { "bitset_batch_and_count", 0, BATCH_SETS + 1, BATCH_MAX, prep_batch,
+        run_batch_and_count, NULL, done_batch },
+    { "bitset_atomic_set", ELEM, 0, 0, prep_atomic, run_atomic_set, NULL,
+        done_atomic },
+    { "bitset_atomic_test_and_set", ELEM, 0, 0, prep_atomic,
+        run_atomic_test_and_set, NULL, done_atomic },
+    { "bitset_atomic_snapshot", 0, 2, 0, prep_atomic, run_atomic_snapshot,
+        NULL, done_atomic },
+    { "bitset256 and/xor/lsh/count", ELEM, 0, 0, NULL, run_fixed256, NULL,
+        NULL },
+};
+
+#define CASES (sizeof cases / sizeof cases[0])
+
+// Times a case, repeating it until it has run for the minimum time. 
+//
+// PARAMS: 
+// c      - the benchmark state
+// run    - the case to run
+// min_ns - the time to run for
+// calls  - the number of calls made
+// ns     - the time taken
+// cyc    - the cycles taken
+static void measure(bench_ctx *c, size_t (*run)(bench_ctx *), double min_ns,
+        size_t *calls, double *ns, uint64_t *cyc) {
+    size_t reps = 1;
+    run(c);         // warms up the caches
+    for (;;) {
+        size_t n = 0;
+        uint64_t c0 = cycles();
+        double t0 = now_ns();
+        for (size_t r = 0; r < reps; r++)
+            n += run(c);
+        double t = now_ns() - t0;
+        uint64_t cy = cycles() - c0;
+        if (t >= min_ns || reps >= ((size_t)1 << 30)) {
+            *calls = n;
+            *ns = t;
+            *cyc = cy;
+            return;
+        }
+        reps *= (t < min_ns / 16) ? 16 : 2;
+    }
+}
+
+// Writes one result to the report and the JSON file. 
+//
+// PARAMS: 
+// json    - the JSON file, or NULL
+// first   - whether this is the first JSON result
+// bc      - the case
+// c       - the benchmark state
+// den     - the density index
+// align   - the alignment index
+// backend - the name of the backend
+// calls   - the number of calls made
+// ns      - the time taken
+// cyc     - the cycles taken
+static void report(FILE *json, _Bool first, const bench_case *bc,
+        const bench_ctx *c, int den, int align, const char *backend,
+        size_t calls, double ns, uint64_t cyc) {
+    size_t nw = BITSET_WORDS(c->n);
+    double op = ns / calls;
+    double gbs = (bc->flags & ELEM) ? 0
+        : (double)bc->operands * nw * sizeof(uint64_t) / op;
+    double cpw = (bc->flags & ELEM) ? (double)cyc / calls
+        : (double)cyc / calls / nw;
+    printf("%-28s %11zu %6s %3zu %-8s %12.1f %8.2f %8.3f\n", bc->name, c->n,
+            density_names[den], align_offsets[align], backend, op, gbs, cpw);
+    if (json != NULL)
+        fprintf(json, "%s\n  {\"name\": \"%s\", \"bits\": %zu, "
+                "\"density\": \"%s\", \"offset\": %zu, \"backend\": \"%s\", "
+                "\"ns_per_op\": %.3f, \"gb_per_s\": %.4f, "
+                "\"%s\": %.4f}", first ? "" : ",", bc->name, c->n,
+                density_names[den], align_offsets[align], backend, op, gbs,
+                (bc->flags & ELEM) ? "cycles_per_op" : "cycles_per_word",
+                cpw);
+}
+
+// Runs a case on every backend it supports. 
+//
+// PARAMS: 
+// bc    - the case
+// c     - the benchmark state
+// o     - the options
+// den   - the density index
+// align - the alignment index
+// json  - the JSON file, or NULL
+// first - whether no JSON result was written yet
+static void run_case(const bench_case *bc, bench_ctx *c, const bench_opts *o,
+        int den, int align, FILE *json, _Bool *first) {
+    const bitset_kernels *native = bitset_kernel;
+    const bitset_kernels *backends[2] = { native, &bitset_kernels_scalar };
+    int nb = (bc->flags & KERNEL) ? 2 : 1;
+    size_t calls;
+    double ns;
+    uint64_t cyc;
+
+    if (bc->prep != NULL && bc->prep(c) != BITSET_GOOD) {
+        fprintf(stderr, "%s: setup failed at %zu bits\n", bc->name, c->n);
+        if (bc->done != NULL)
+            bc->done(c);
+        return;
+    }
+    for (int k = 0; k < nb; k++) {
+        bitset_kernel = backends[k];
+        memcpy(c->a.bits, c->orig, BITSET_WORDS(c->n) * sizeof(uint64_t));
+        bitset_cache_invalidate(&c->a);
+        measure(c, bc->run, o->min_ns, &calls, &ns, &cyc);
+        report(json, *first, bc, c, den, align, bitset_kernel->name, calls,
+                ns, cyc);
+        *first = false;
+    }
+    bitset_kernel = native;
+    if (bc->run_par != NULL && c->pool != NULL) {
+        memcpy(c->a.bits, c->orig, BITSET_WORDS(c->n) * sizeof(uint64_t));
+        measure(c, bc->run_par, o->min_ns, &calls, &ns, &cyc);
+        report(json, *first, bc, c, den, align, "parallel", calls, ns, cyc);
+        *first = false;
+    }
+    if (bc->done != NULL)
+        bc->done(c);
+}
+
+// Parses the command line. 
+//
+// PARAMS: 
+// argc - the number of arguments
+// argv - the arguments
+// o    - the options to fill
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int parse(int argc, char **argv, bench_opts *o) {
+    o->min_bits = 64;
+    o->max_bits = (size_t)1 << 30;
+    o->min_ns = 20e6;
+    o->filter = NULL;
+    o->json = NULL;
+    o->threads = 0;
+    for (int i = 1; i < argc; i++) {
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (v == NULL) {
+            return 1;
+        } else if (strcmp(argv[i], "-n") == 0) {
+            o->min_bits = strtoull(v, NULL, 0);
+        } else if (strcmp(argv[i], "-m") == 0) {
+            o->max_bits = strtoull(v, NULL, 0);
+        } else if (strcmp(argv[i], "-t") == 0) {
+            o->min_ns = strtod(v, NULL) * 1e6;
+        } else if (strcmp(argv[i], "-f") == 0) {
+            o->filter = v;
+        } else if (strcmp(argv[i], "-j") == 0) {
+            o->json = v;
+        } else if (strcmp(argv[i], "-p") == 0) {
+            o->threads = strtoull(v, NULL, 0);
+        } else {
+            return 1;
+        }
+        i++;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    bench_opts o;
+    if (parse(argc, argv, &o) != 0) {
+        fprintf(stderr, "usage: %s [-n min bits] [-m max bits] [-t ms per "
+                "case]\n        [-f name filter] [-j results.json] "
+                "[-p threads]\n", argv[0]);
+        return 1;
+    }
+
+    static bench_ctx c;
+    FILE *json = NULL;
+    _Bool first = true;
+    if (o.json != NULL) {
+        json = fopen(o.json, "w");
+        if (json == NULL) {
+            perror(o.json);
+            return 1;
+        }
+        fprintf(json, "{\"kernels\": \"%s\", \"results\": [",
+                bitset_kernel->name);
+    }
+    if (bitset_pool_init(&c.pool, o.threads) != BITSET_GOOD)
+        c.pool = NULL;
+
+    printf("%-28s %11s %6s %3s %-8s %12s %8s %8s\n", "function", "bits",
+            "dense", "off", "backend", "ns/op", "GB/s", "cyc/word");
+    for (int s = 0; s < SIZES; s++) {
+        size_t n = (size_t)64 << (4 * s);
+        if (n < o.min_bits || n > o.max_bits)
+            continue;
+        for (int den = 0; den < DENSITIES; den++) {
+            for (int al = 0; al < ALIGNS; al++) {
+                if (setup(&c, n, density_ands[den], align_offsets[al])
+                        != BITSET_GOOD) {
+                    fprintf(stderr, "out of memory at %zu bits\n", n);
+                    continue;
+                }
+                for (size_t i = 0; i < CASES; i++) {
+                    const bench_case *bc = &cases[i];
+                    if ((den != 0 && !(bc->flags & DENSE))
+                            || (al != 0 && !(bc->flags & ALIGNED))
+                            || (bc->max_bits != 0 && n > bc->max_bits)
+                            || (o.filter != NULL
+                                && strstr(bc->name, o.filter) == NULL))
+                        continue;
+                    run_case(bc, &c, &o, den, al, json, &first);
+                }
+                teardown(&c);
+            }
+        }
+    }
+
+    bitset_pool_free(c.pool);
+    if (json != NULL) {
+        fprintf(json, "\n]}\n");
+        fclose(json);
+    }
+    return 0;
+}
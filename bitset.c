@@ -7,9 +7,90 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "bitset.h"
+#include "bitset_kernel.h"
+#include "bitset_stats.h"
 #define CHAR_LEN 8
+#define WORD_LEN BITSET_WORD_LEN
+#define WORD_ALL UINT64_MAX
+#define PREFETCH_AHEAD 16
+#define BLOCK_WORDS 512
+#define SLICE_WORDS 32
+#define CACHE_WORDS 512
 
-static _Bool *bits_from_char(unsigned char c);
+// Generates the table of bytes with their bit order reversed. 
+#define REV2(n) (n), (n) + 2 * 64, (n) + 1 * 64, (n) + 3 * 64
+#define REV4(n) REV2(n), REV2((n) + 2 * 16), REV2((n) + 1 * 16), \
+    REV2((n) + 3 * 16)
+#define REV6(n) REV4(n), REV4((n) + 2 * 4), REV4((n) + 1 * 4), \
+    REV4((n) + 3 * 4)
+
+// Every byte with its bit order reversed, so the most significant bit of a 
+// character becomes its first bit. 
+static const unsigned char rev_char[256] = {
+    REV6(0), REV6(2), REV6(1), REV6(3)
+};
+
+// Returns the bytes of k operands as long as b, counted by BITSET_STAT. 
+#define STAT_BYTES(b, k) \
+    (((b) != NULL) ? BITSET_WORDS((b)->len) * sizeof(uint64_t) * (k) : 0)
+
+// Returns the mask of bit i within its word. 
+#define BIT_MASK(i) ((uint64_t)1 << ((i) % WORD_LEN))
+
+#define RANGE_SET 0
+#define RANGE_CLEAR 1
+#define RANGE_FLIP 2
+
+// Prefetches the word of idx[k] for writing, if k is a valid index. 
+#if defined(__GNUC__)
+#define PREFETCH_BIT(w, idx, k, count) \
+    do { \
+        if ((k) < (count)) \
+            __builtin_prefetch((w) + (idx)[k] / WORD_LEN, 1); \
+    } while (0)
+#else
+#define PREFETCH_BIT(w, idx, k, count) ((void)0)
+#endif
+
+static int alloc_bits(bitset *b, size_t n, const bitset_allocator *alloc);
+static void borrowed_release(void *p, size_t size, void *ctx);
+static int grow(bitset *b, size_t words);
+static int cache_fit(bitset *b, size_t words);
+static void cache_bit(const bitset *b, size_t i, _Bool v);
+static void cache_mark(const bitset *b, size_t lo, size_t hi);
+static void cache_indices(const bitset *b, const size_t *idx, size_t count);
+static void cache_update(const bitset *b);
+static uint64_t tail_mask(size_t n);
+static uint64_t bits_get(const uint64_t *w, size_t pos, size_t n);
+static void bits_put(uint64_t *w, size_t pos, size_t n, uint64_t v);
+static uint64_t reverse64(uint64_t w);
+static void bits_reverse(uint64_t *w, size_t pos, size_t n);
+static void bits_rotate(uint64_t *w, size_t len, size_t n);
+static void range_op(uint64_t *w, size_t pos, size_t n, int op);
+static int check_index(const bitset *b, size_t i);
+static int check_range(const bitset *b, size_t pos, size_t n);
+static int check_indices(const bitset *b, const size_t *idx, size_t count);
+static int check_binary(const bitset *a, const bitset *b);
+static int check_binary3(const bitset *dst, const bitset *a, const bitset *b);
+static int check_many(const bitset *dst, const bitset **srcs, size_t k);
+static void many_op(bitset *dst, const bitset **srcs, size_t k,
+        void (*fn)(uint64_t *, const uint64_t *, const uint64_t *, size_t),
+        _Bool stop_zero);
+static void threshold_block(uint64_t *dst, const bitset **srcs, size_t k,
+        size_t t, size_t off, size_t n);
+
+// The allocator of memory owned by someone else, which is never released. 
+static const bitset_allocator borrowed = { NULL, borrowed_release, NULL };
+
+// The cached count of a bitset, kept for each block of CACHE_WORDS words so 
+// that a change only needs its own blocks recounted. 
+struct bitset_cache_t {
+    size_t count;       // total of the block counts
+    size_t nblocks;     // number of blocks, covering the capacity
+    uint32_t *counts;   // number of bits set to 1 in each block
+    uint64_t *dirty;    // one bit for each block that needs a recount
+    _Bool stale;        // whether any block needs a recount
+};
 
 // Initialises the specified bitset. 
 //
@@ -20,15 +101,7 @@ static _Bool *bits_from_char(unsigned char c);
 // RET: 
 // Zero on success, non-zero on error. 
 int bitset_init(bitset *b, size_t n) {
-    if (b == NULL || n == 0)
-        return BITSET_NULL_ERR;
-
-    int ret = BITSET_GOOD;
-    b->len = n;
-    b->bits = calloc(n, sizeof(_Bool));
-    if (b->bits == NULL)
-        ret = BITSET_ALLOC_ERR;
-    return ret;
+    return bitset_init_alloc(b, n, NULL);
 }
 
 // Initialises the specified bitset from a bit string. 
@@ -41,18 +114,7 @@ int bitset_init(bitset *b, size_t n) {
 // RET: 
 // Zero on success, non-zero on error. 
 int bitset_init_bstr(bitset *b, const char *str, size_t n) {
-    if (b == NULL || str == NULL || n == 0)
-        return BITSET_NULL_ERR;
-
-    int ret = BITSET_ALLOC_ERR;
-    b->len = n;
-    b->bits = calloc(n, sizeof(_Bool));
-    if (b->bits != NULL) {
-        ret = BITSET_GOOD;
-        for (size_t i = 0; i < n && str[i] != '\0'; i++)
-            b->bits[i] = (str[i] == '1') ? true : false;
-    }
-    return ret;
+    return bitset_init_bstr_alloc(b, str, n, NULL);
 }
 
 // Initialises the specified bitset from a string. Each character will take 
@@ -66,288 +128,1833 @@ int bitset_init_bstr(bitset *b, const char *str, size_t n) {
 // RET: 
 // Zero on success, non-zero on error. 
 int bitset_init_str(bitset *b, const char *str, size_t n) {
-    if (b == NULL || str == NULL || n == 0)
+    return bitset_init_str_alloc(b, str, n, NULL);
+}
+
+// Initialises the specified bitset, allocating its bits from an allocator. 
+//
+// PARAMS: 
+// b     - the bitset to initialise
+// n     - the length of the bitset
+// alloc - the allocator to use, or NULL for malloc
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_init_alloc(bitset *b, size_t n, const bitset_allocator *alloc) {
+    BITSET_STAT(INIT_ALLOC, BITSET_WORDS(n) * sizeof(uint64_t));
+    if (b == NULL || n == 0)
         return BITSET_NULL_ERR;
 
-    int ret = BITSET_ALLOC_ERR;
-    b->len = n * CHAR_LEN;
-    b->bits = calloc(b->len, sizeof(_Bool));
-    if (b->bits != NULL) {
-        ret = BITSET_GOOD;
-        for (size_t i = 0; i < n && str[i] != '\0'; i++) {
-            _Bool *bin = bits_from_char(str[i]);
-            memcpy(b->bits + (i * CHAR_LEN), bin, CHAR_LEN * (sizeof *bin));
-        }
-    }
+    return alloc_bits(b, n, alloc);
+}
+
+// Initialises the specified bitset on caller-provided memory, without 
+// allocating. Every bit is set to 0. The memory must stay valid while the 
+// bitset is used, and freeing the bitset leaves it alone. 
+//
+// PARAMS: 
+// b   - the bitset to initialise
+// mem - the memory to use, 8-byte aligned and BITSET_WORDS(n) words long
+// n   - the length of the bitset
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_init_buffer(bitset *b, void *mem, size_t n) {
+    BITSET_STAT(INIT_BUFFER, BITSET_WORDS(n) * sizeof(uint64_t));
+    if (b == NULL || mem == NULL || n == 0)
+        return BITSET_NULL_ERR;
+    if ((uintptr_t)mem % sizeof(uint64_t) != 0)
+        return BITSET_RANGE_ERR;
+    if (n > SIZE_MAX - WORD_LEN)
+        return BITSET_LENGTH_ERR;
+
+    b->bits = mem;
+    b->len = n;
+    b->alloc = &borrowed;
+    b->cap = BITSET_WORDS(n);
+    b->cache = NULL;
+    memset(b->bits, 0, BITSET_WORDS(n) * sizeof(uint64_t));
+    return BITSET_GOOD;
+}
+
+// Initialises the specified bitset with its bits stored inside the bitset 
+// itself, without allocating. The bitset must not be copied or moved by 
+// assignment afterwards. 
+//
+// PARAMS: 
+// b - the bitset to initialise
+// n - the length of the bitset, at most BITSET_INLINE_LEN
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_init_inline(bitset *b, size_t n) {
+    if (b == NULL || n == 0)
+        return BITSET_NULL_ERR;
+    if (n > BITSET_INLINE_LEN)
+        return BITSET_LENGTH_ERR;
+
+    memset(b->small, 0, sizeof b->small);
+    int ret = bitset_init_buffer(b, b->small, n);
+    b->cap = BITSET_INLINE_WORDS;
     return ret;
 }
 
-// Returns the number of bits set to 1. 
+// Initialises the specified bitset from a bit string, allocating its bits 
+// from an allocator. 
 //
 // PARAMS: 
-// b - the bitset to check
+// b     - the bitset to initialise
+// str   - the bit string to initialise
+// n     - the length of the bit string
+// alloc - the allocator to use, or NULL for malloc
 //
 // RET: 
-// The number of bits that is set to 1. 
-size_t bitset_true_len(const bitset *b) {
-    if (b == NULL || b->bits == NULL)
-        return 0;
+// Zero on success, non-zero on error. 
+int bitset_init_bstr_alloc(bitset *b, const char *str, size_t n,
+        const bitset_allocator *alloc) {
+    BITSET_STAT(INIT_BSTR_ALLOC, n + BITSET_WORDS(n) * sizeof(uint64_t));
+    if (b == NULL || str == NULL || n == 0)
+        return BITSET_NULL_ERR;
 
-    size_t ret = 0;
-    for (size_t i = 0; i < b->len; i++)
-        ret += (b->bits[i]) ? 1 : 0;
+    int ret = alloc_bits(b, n, alloc);
+    if (ret == BITSET_GOOD) {
+        const char *end = memchr(str, '\0', n);
+        size_t m = (end != NULL) ? (size_t)(end - str) : n;
+        bitset_kernel->from_bstr(b->bits, str, m);
+    }
     return ret;
 }
 
-// Determines whether every bit in the bitset is set to 1. 
+// Initialises the specified bitset from a string, allocating its bits from 
+// an allocator. Each character will take 8 bits. 
 //
 // PARAMS: 
-// b - the bitset to test
+// b     - the bitset to initialise
+// str   - the string to initialise
+// n     - the length of the string
+// alloc - the allocator to use, or NULL for malloc
 //
 // RET: 
-// True or false depending on whether every bit is set to 1. 
-_Bool bitset_all(const bitset *b) {
-    if (b == NULL || b->bits == NULL)
-        return false;
-    
-    for (size_t i = 0; i < b->len; i++)
-        if (!b->bits[i])
-            return false;
-    return true;
+// Zero on success, non-zero on error. 
+int bitset_init_str_alloc(bitset *b, const char *str, size_t n,
+        const bitset_allocator *alloc) {
+    BITSET_STAT(INIT_STR_ALLOC, n + n);
+    if (b == NULL || str == NULL || n == 0)
+        return BITSET_NULL_ERR;
+    if (n > (SIZE_MAX - WORD_LEN) / CHAR_LEN)
+        return BITSET_LENGTH_ERR;
+
+    int ret = alloc_bits(b, n * CHAR_LEN, alloc);
+    if (ret == BITSET_GOOD) {
+        const unsigned char *s = (const unsigned char *)str;
+        const unsigned char *end = memchr(s, '\0', n);
+        size_t m = (end != NULL) ? (size_t)(end - s) : n;
+        size_t per = WORD_LEN / CHAR_LEN;   // characters per word
+        for (size_t i = 0; i < m; i += per) {
+            size_t k = (m - i < per) ? m - i : per;
+            uint64_t w = 0;
+            for (size_t j = 0; j < k; j++)
+                w |= (uint64_t)rev_char[s[i + j]] << (j * CHAR_LEN);
+            b->bits[i / per] = w;
+        }
+    }
+    return ret;
 }
 
-// Determines whether any bit in the bitset is set to 1. 
+// Initialises a bitset as a copy of another, with its bits from the same 
+// allocator. Bits in borrowed or inline memory are copied to the heap, and 
+// a cached count is not copied. 
 //
 // PARAMS: 
-// b - the bitset to test
+// dst - the bitset to initialise, not holding any bits
+// src - the bitset to copy
 //
 // RET: 
-// True or false depending on whether any bit is set to 1. 
-_Bool bitset_any(const bitset *b) {
-    if (b == NULL || b->bits == NULL)
-        return false;
+// Zero on success, non-zero on error. 
+int bitset_copy(bitset *dst, const bitset *src) {
+    BITSET_STAT(COPY, STAT_BYTES(src, 2));
+    if (dst == NULL || src == NULL || src->bits == NULL)
+        return BITSET_NULL_ERR;
 
-    for (size_t i = 0; i < b->len; i++)
-        if (b->bits[i])
-            return true;
-    return false;
+    int ret = alloc_bits(dst, src->len, (src->alloc == NULL
+            || src->alloc->alloc == NULL) ? NULL : src->alloc);
+    if (ret == BITSET_GOOD)
+        memcpy(dst->bits, src->bits, dst->cap * sizeof(uint64_t));
+    return ret;
 }
 
-// Performs AND operation, storing output in the left operand. 
+// Moves the bits of a bitset to another without copying them, leaving the 
+// source freed. Inline bits are copied into the destination. 
 //
 // PARAMS: 
-// lhs - the left operand
-// rhs - the right operand
+// dst - the bitset to move to, not holding any bits
+// src - the bitset to move from
 //
 // RET: 
 // Zero on success, non-zero on error. 
-int bitset_and(bitset *lhs, const bitset *rhs) {
-    if (lhs == NULL || rhs == NULL || lhs->bits == NULL || rhs->bits == NULL)
+int bitset_move(bitset *dst, bitset *src) {
+    BITSET_STAT(MOVE, 0);
+    if (dst == NULL || src == NULL)
         return BITSET_NULL_ERR;
-    if (lhs->len != rhs->len)
-        return BITSET_LENGTH_ERR;
+    if (dst == src)
+        return BITSET_GOOD;
 
-    for (size_t i = 0; i < lhs->len; i++)
-        lhs->bits[i] &= rhs->bits[i];
+    *dst = *src;
+    if (src->bits == src->small)
+        dst->bits = dst->small;     // inline bits point into the bitset
+    src->bits = NULL;
+    src->len = 0;
+    src->cap = 0;
+    src->cache = NULL;
     return BITSET_GOOD;
 }
 
-// Performs OR operation, storing output in the left operand. 
+// Swaps the bits of two bitsets without copying them, other than inline 
+// bits. 
 //
 // PARAMS: 
-// lhs - the left operand
-// rhs - the right operand
+// a - the first bitset
+// b - the second bitset
+void bitset_swap(bitset *a, bitset *b) {
+    if (a != NULL && b != NULL && a != b) {
+        bitset t;
+        bitset_move(&t, a);
+        bitset_move(a, b);
+        bitset_move(b, &t);
+    }
+}
+
+// Writes the bitset as a bit string of '0' and '1' characters, followed by 
+// a NUL. 
+//
+// PARAMS: 
+// b   - the bitset to write
+// buf - the output buffer, with room for the length of the bitset plus 1
 //
 // RET: 
 // Zero on success, non-zero on error. 
-int bitset_or(bitset *lhs, const bitset *rhs) {
-    if (lhs == NULL || rhs == NULL || lhs->bits == NULL || rhs->bits == NULL)
+int bitset_to_bstr(const bitset *b, char *buf) {
+    BITSET_STAT(TO_BSTR, STAT_BYTES(b, 9));
+    if (b == NULL || b->bits == NULL || buf == NULL)
         return BITSET_NULL_ERR;
-    if (lhs->len != rhs->len)
-        return BITSET_LENGTH_ERR;
 
-    for (size_t i = 0; i < lhs->len; i++)
-        lhs->bits[i] |= rhs->bits[i];
+    bitset_kernel->to_bstr(buf, b->bits, b->len);
+    buf[b->len] = '\0';
     return BITSET_GOOD;
 }
 
-// Performs XOR operation, storing output in the left operand. 
+// Makes sure the specified bitset can grow to a length without allocating. 
+// Memory from bitset_init_buffer or bitset_init_inline is moved to the heap 
+// when it is too small. 
 //
 // PARAMS: 
-// lhs - the left operand
-// rhs - the right operand
+// b - the bitset to reserve for
+// n - the length in bits to make room for
 //
 // RET: 
 // Zero on success, non-zero on error. 
-int bitset_xor(bitset *lhs, const bitset *rhs) {
-    if (lhs == NULL || rhs == NULL || lhs->bits == NULL || rhs->bits == NULL)
+int bitset_reserve(bitset *b, size_t n) {
+    BITSET_STAT(RESERVE, STAT_BYTES(b, 1));
+    if (b == NULL || b->bits == NULL)
         return BITSET_NULL_ERR;
-    if (lhs->len != rhs->len)
+    if (n > SIZE_MAX - WORD_LEN)
         return BITSET_LENGTH_ERR;
 
-    for (size_t i = 0; i < lhs->len; i++)
-        lhs->bits[i] ^= rhs->bits[i];
-    return BITSET_GOOD;
+    return (BITSET_WORDS(n) <= b->cap) ? BITSET_GOOD
+        : grow(b, BITSET_WORDS(n));
 }
 
-// Performs NOT operation. 
+// Changes the length of the specified bitset. New bits are set to 0, and 
+// the capacity grows geometrically so that repeated growth is amortised. 
 //
 // PARAMS: 
-// b - the bitset to perform NOT
+// b - the bitset to resize
+// n - the new length of the bitset
 //
 // RET: 
 // Zero on success, non-zero on error. 
-int bitset_not(bitset *b) {
+int bitset_resize(bitset *b, size_t n) {
+    BITSET_STAT(RESIZE, STAT_BYTES(b, 1));
     if (b == NULL || b->bits == NULL)
         return BITSET_NULL_ERR;
+    if (n == 0 || n > SIZE_MAX - WORD_LEN)
+        return BITSET_LENGTH_ERR;
+
+    size_t nw = BITSET_WORDS(n), old = BITSET_WORDS(b->len);
+    if (nw > b->cap) {
+        size_t cap = (b->cap > SIZE_MAX / 2) ? nw : b->cap * 2;
+        int ret = grow(b, (cap > nw) ? cap : nw);
+        if (ret != BITSET_GOOD)
+            return ret;
+    }
 
-    for (size_t i = 0; i < b->len; i++)
-        b->bits[i] = (b->bits[i]) ? false : true;
+    // keep every bit past the new length at 0
+    if (n < b->len) {
+        memset(b->bits + nw, 0, (old - nw) * sizeof(uint64_t));
+        b->bits[nw - 1] &= tail_mask(n);
+        cache_mark(b, nw - 1, old);
+    }
+    b->len = n;
     return BITSET_GOOD;
 }
 
-// Performs left shift. 
+// Appends a bit to the end of the specified bitset. 
 //
 // PARAMS: 
-// b - the bitset to left shift
-// n - the number of shifts
+// b - the bitset to append to
+// v - the value of the new bit
 //
 // RET: 
 // Zero on success, non-zero on error. 
-int bitset_lsh(bitset *b, size_t n) {
+int bitset_push_back(bitset *b, _Bool v) {
+    BITSET_STAT(PUSH_BACK, sizeof(uint64_t));
     if (b == NULL || b->bits == NULL)
         return BITSET_NULL_ERR;
-    if (n == 0)
-        return BITSET_GOOD;     // no shifts needed
 
-    if (n >= b->len) {
-        memset(b->bits, 0, b->len * sizeof(_Bool));
-    } else {
-        size_t sh = b->len - n; // shift length
-        memmove(b->bits, b->bits + n, sh * sizeof(_Bool));
-        memset(b->bits + sh, 0, n * sizeof(_Bool));
+    size_t i = b->len;
+    int ret = bitset_resize(b, i + 1);
+    if (ret == BITSET_GOOD && v) {
+        cache_bit(b, i, true);
+        b->bits[i / WORD_LEN] |= BIT_MASK(i);
     }
-    return BITSET_GOOD;
+    return ret;
 }
 
-// Performs right shift. 
+// Appends the bits of a bitset to the end of another. The bitsets may be 
+// the same. 
 //
 // PARAMS: 
-// b - the bitset to right shift
-// n - the number of shifts
+// b   - the bitset to append to
+// src - the bitset to append
 //
 // RET: 
 // Zero on success, non-zero on error. 
-int bitset_rsh(bitset *b, size_t n) {
-    if (b == NULL || b->bits == NULL)
+int bitset_append(bitset *b, const bitset *src) {
+    BITSET_STAT(APPEND, STAT_BYTES(src, 2));
+    if (b == NULL || src == NULL || b->bits == NULL || src->bits == NULL)
         return BITSET_NULL_ERR;
-    if (n == 0)
-        return BITSET_GOOD;     // no shifts needed
+    if (src->len > SIZE_MAX - WORD_LEN - b->len)
+        return BITSET_LENGTH_ERR;
 
-    if (n >= b->len) {
-        memset(b->bits, 0, b->len * sizeof(_Bool));
-    } else {
-        size_t sh = b->len - n; // shift length
-        memmove(b->bits + n, b->bits, sh * sizeof(_Bool));
-        memset(b->bits, 0, n * sizeof(_Bool));
+    size_t pos = b->len, n = src->len;
+    int ret = bitset_resize(b, pos + n);
+    if (ret != BITSET_GOOD)
+        return ret;
+
+    // go backwards, so appending a bitset to itself reads each word before 
+    // it is written
+    size_t i = pos / WORD_LEN, off = pos % WORD_LEN;
+    for (size_t j = BITSET_WORDS(n); j-- > 0; ) {
+        uint64_t v = src->bits[j];
+        if (off != 0 && i + j + 1 < b->cap)
+            b->bits[i + j + 1] |= v >> (WORD_LEN - off);
+        b->bits[i + j] |= v << off;
     }
+    cache_mark(b, i, i + BITSET_WORDS(n) + 1);
     return BITSET_GOOD;
+}
 
+// Changes the specified bit to 1. 
+//
+// PARAMS: 
+// b - the bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_set_checked(bitset *b, size_t i) {
+    BITSET_STAT(SET_CHECKED, sizeof(uint64_t));
+    int ret = check_index(b, i);
+    if (ret == BITSET_GOOD) {
+        cache_bit(b, i, true);
+        bitset_set(b, i);
+    }
+    return ret;
 }
 
-// Performs left rotate. 
+// Changes the specified bit to 0. 
 //
 // PARAMS: 
-// b - the bitset to left rotate
-// n - the number of shifts
+// b - the bitset to change
+// i - the index of the bit
 //
 // RET: 
 // Zero on success, non-zero on error. 
-int bitset_lrot(bitset *b, size_t n) {
-    if (b == NULL || b->bits == NULL)
-        return BITSET_NULL_ERR;
-    if (n % b->len == 0)
-        return BITSET_GOOD;     // no need to rotate
+int bitset_clear_checked(bitset *b, size_t i) {
+    BITSET_STAT(CLEAR_CHECKED, sizeof(uint64_t));
+    int ret = check_index(b, i);
+    if (ret == BITSET_GOOD) {
+        cache_bit(b, i, false);
+        bitset_clear(b, i);
+    }
+    return ret;
+}
 
-    int ret = BITSET_ALLOC_ERR;
-    n %= b->len;
-    size_t rot = b->len - n;
-    _Bool *temp = malloc(n * (sizeof *temp));
-    if (temp != NULL) {
-        memcpy(temp, b->bits, n * (sizeof *temp));
-        memmove(b->bits, b->bits + n, rot * (sizeof *temp));
-        memcpy(b->bits + rot, temp, n * (sizeof *temp));
-        free(temp);
-        ret = BITSET_GOOD;
+// Inverts the specified bit. 
+//
+// PARAMS: 
+// b - the bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_flip_checked(bitset *b, size_t i) {
+    BITSET_STAT(FLIP_CHECKED, sizeof(uint64_t));
+    int ret = check_index(b, i);
+    if (ret == BITSET_GOOD) {
+        cache_bit(b, i, !bitset_test(b, i));
+        bitset_flip(b, i);
     }
     return ret;
 }
 
-// Performs right rotate. 
+// Determines whether the specified bit is set to 1. 
 //
 // PARAMS: 
-// b - the bitset to right rotate
-// n - the number of shifts
+// b - the bitset to test
+// i - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit is set to 1. False on error. 
+_Bool bitset_test_checked(const bitset *b, size_t i) {
+    BITSET_STAT(TEST_CHECKED, sizeof(uint64_t));
+    return check_index(b, i) == BITSET_GOOD && bitset_test(b, i);
+}
+
+// Applies a word operation to the bit of every index, prefetching the words 
+// a few indices ahead. 
+#define BITS_MANY(w, idx, count, op) \
+    do { \
+        size_t i = 0; \
+        for (; i + 4 <= (count); i += 4) { \
+            PREFETCH_BIT(w, idx, i + PREFETCH_AHEAD, count); \
+            PREFETCH_BIT(w, idx, i + PREFETCH_AHEAD + 1, count); \
+            PREFETCH_BIT(w, idx, i + PREFETCH_AHEAD + 2, count); \
+            PREFETCH_BIT(w, idx, i + PREFETCH_AHEAD + 3, count); \
+            w[idx[i] / WORD_LEN] op BIT_MASK(idx[i]); \
+            w[idx[i + 1] / WORD_LEN] op BIT_MASK(idx[i + 1]); \
+            w[idx[i + 2] / WORD_LEN] op BIT_MASK(idx[i + 2]); \
+            w[idx[i + 3] / WORD_LEN] op BIT_MASK(idx[i + 3]); \
+        } \
+        for (; i < (count); i++) \
+            w[idx[i] / WORD_LEN] op BIT_MASK(idx[i]); \
+    } while (0)
+
+// Changes the specified bits to 1. Nothing is changed if any index is out 
+// of range. 
+//
+// PARAMS: 
+// b     - the bitset to change
+// idx   - the indices of the bits
+// count - the number of indices
 //
 // RET: 
 // Zero on success, non-zero on error. 
-int bitset_rrot(bitset *b, size_t n) {
-    if (b == NULL || b->bits == NULL)
-        return BITSET_NULL_ERR;
-    if (n % b->len == 0)
-        return BITSET_GOOD;     // no need to rotate
+int bitset_set_many(bitset *b, const size_t *idx, size_t count) {
+    BITSET_STAT(SET_MANY, count * (sizeof(uint64_t) + sizeof(size_t)));
+    int ret = check_indices(b, idx, count);
+    if (ret == BITSET_GOOD) {
+        BITS_MANY(b->bits, idx, count, |=);
+        cache_indices(b, idx, count);
+    }
+    return ret;
+}
+
+// Changes the specified bits to 0. Nothing is changed if any index is out 
+// of range. 
+//
+// PARAMS: 
+// b     - the bitset to change
+// idx   - the indices of the bits
+// count - the number of indices
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_clear_many(bitset *b, const size_t *idx, size_t count) {
+    BITSET_STAT(CLEAR_MANY, count * (sizeof(uint64_t) + sizeof(size_t)));
+    int ret = check_indices(b, idx, count);
+    if (ret == BITSET_GOOD) {
+        BITS_MANY(b->bits, idx, count, &= ~);
+        cache_indices(b, idx, count);
+    }
+    return ret;
+}
 
-    int ret = BITSET_ALLOC_ERR;
-    n %= b->len;
-    size_t rot = b->len - n;
-    _Bool *temp = malloc(n * (sizeof *temp));
-    if (temp != NULL) {
-        memcpy(temp, b->bits + rot, n * (sizeof *temp));
-        memmove(b->bits + n, b->bits, rot * (sizeof *temp));
-        memcpy(b->bits, temp, n * (sizeof *temp));
-        free(temp);
-        ret = BITSET_GOOD;
+// Inverts the specified bits. An index given more than once is inverted 
+// more than once. Nothing is changed if any index is out of range. 
+//
+// PARAMS: 
+// b     - the bitset to change
+// idx   - the indices of the bits
+// count - the number of indices
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_flip_many(bitset *b, const size_t *idx, size_t count) {
+    BITSET_STAT(FLIP_MANY, count * (sizeof(uint64_t) + sizeof(size_t)));
+    int ret = check_indices(b, idx, count);
+    if (ret == BITSET_GOOD) {
+        BITS_MANY(b->bits, idx, count, ^=);
+        cache_indices(b, idx, count);
     }
     return ret;
 }
 
-// Resets the bitset, changing all bits to 0. 
+// Changes a range of bits to 1. 
 //
 // PARAMS: 
-// b - the bitset to reset
-void bitset_reset(bitset *b) {
-    if (b != NULL && b->bits != NULL)
-        for (size_t i = 0; i < b->len; i++)
-            b->bits[i] = false;
+// b   - the bitset to change
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_set_range(bitset *b, size_t pos, size_t n) {
+    BITSET_STAT(SET_RANGE, BITSET_WORDS(n) * sizeof(uint64_t));
+    int ret = check_range(b, pos, n);
+    if (ret == BITSET_GOOD && n > 0) {
+        range_op(b->bits, pos, n, RANGE_SET);
+        cache_mark(b, pos / WORD_LEN, BITSET_WORDS(pos + n));
+    }
+    return ret;
 }
 
-// Frees the internal storage of the given bitset. 
+// Changes a range of bits to 0. 
 //
 // PARAMS: 
-// b - the bitset to free
-void bitset_free(bitset *b) {
-    if (b != NULL) {
-        free(b->bits);
-        b->bits = NULL;
+// b   - the bitset to change
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_clear_range(bitset *b, size_t pos, size_t n) {
+    BITSET_STAT(CLEAR_RANGE, BITSET_WORDS(n) * sizeof(uint64_t));
+    int ret = check_range(b, pos, n);
+    if (ret == BITSET_GOOD && n > 0) {
+        range_op(b->bits, pos, n, RANGE_CLEAR);
+        cache_mark(b, pos / WORD_LEN, BITSET_WORDS(pos + n));
+    }
+    return ret;
+}
+
+// Inverts a range of bits. 
+//
+// PARAMS: 
+// b   - the bitset to change
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_flip_range(bitset *b, size_t pos, size_t n) {
+    BITSET_STAT(FLIP_RANGE, BITSET_WORDS(n) * sizeof(uint64_t));
+    int ret = check_range(b, pos, n);
+    if (ret == BITSET_GOOD && n > 0) {
+        range_op(b->bits, pos, n, RANGE_FLIP);
+        cache_mark(b, pos / WORD_LEN, BITSET_WORDS(pos + n));
+    }
+    return ret;
+}
+
+// Returns the number of bits set to 1 in a range. 
+//
+// PARAMS: 
+// b   - the bitset to check
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// The number of bits set to 1, or 0 on error. 
+size_t bitset_count_range(const bitset *b, size_t pos, size_t n) {
+    BITSET_STAT(COUNT_RANGE, BITSET_WORDS(n) * sizeof(uint64_t));
+    if (check_range(b, pos, n) != BITSET_GOOD || n == 0)
+        return 0;
+
+    size_t i = pos / WORD_LEN, j = (pos + n - 1) / WORD_LEN;
+    uint64_t head = WORD_ALL << (pos % WORD_LEN);
+    uint64_t tail = tail_mask(pos + n);
+    if (i == j)
+        return bitset_popcount64(b->bits[i] & head & tail);
+    return bitset_popcount64(b->bits[i] & head)
+        + bitset_kernel->popcount(b->bits + i + 1, j - i - 1)
+        + bitset_popcount64(b->bits[j] & tail);
+}
+
+// Determines whether any bit in a range is set to 1. 
+//
+// PARAMS: 
+// b   - the bitset to test
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// True or false depending on whether any bit is set to 1. False on error. 
+_Bool bitset_any_range(const bitset *b, size_t pos, size_t n) {
+    BITSET_STAT(ANY_RANGE, BITSET_WORDS(n) * sizeof(uint64_t));
+    if (check_range(b, pos, n) != BITSET_GOOD || n == 0)
+        return false;
+
+    size_t i = pos / WORD_LEN, j = (pos + n - 1) / WORD_LEN;
+    uint64_t head = WORD_ALL << (pos % WORD_LEN);
+    uint64_t tail = tail_mask(pos + n);
+    if (i == j)
+        return (b->bits[i] & head & tail) != 0;
+    return (b->bits[i] & head) != 0 || (b->bits[j] & tail) != 0
+        || bitset_kernel->any_words(b->bits + i + 1, j - i - 1);
+}
+
+// Returns the index of the first bit set to 1 at or after a position. 
+//
+// PARAMS: 
+// b    - the bitset to search
+// from - the position to start searching at
+//
+// RET: 
+// The index of the bit, or BITSET_NPOS if there is none. 
+size_t bitset_next_set(const bitset *b, size_t from) {
+    BITSET_STAT(NEXT_SET, sizeof(uint64_t));
+    if (b == NULL || b->bits == NULL || from >= b->len)
+        return BITSET_NPOS;
+
+    size_t i = from / WORD_LEN, nw = BITSET_WORDS(b->len);
+    uint64_t w = b->bits[i] & (WORD_ALL << (from % WORD_LEN));
+    while (w == 0) {
+        if (++i >= nw)
+            return BITSET_NPOS;
+        w = b->bits[i];
     }
+    return i * WORD_LEN + bitset_ctz64(w);
 }
 
-// Returns the bit representation of a character. The length of the bits will 
-// be 8. 
+// Returns the index of the first bit set to 0 at or after a position. 
 //
 // PARAMS: 
-// c - the character to convert
+// b    - the bitset to search
+// from - the position to start searching at
 //
 // RET: 
-// The bit representation of the character. 
-static _Bool *bits_from_char(unsigned char c) {
-    static _Bool bits[] = {0, 0, 0, 0, 0, 0, 0, 0};
-    memset(bits, 0, CHAR_LEN * (sizeof *bits));
+// The index of the bit, or BITSET_NPOS if there is none. 
+size_t bitset_next_clear(const bitset *b, size_t from) {
+    BITSET_STAT(NEXT_CLEAR, sizeof(uint64_t));
+    if (b == NULL || b->bits == NULL || from >= b->len)
+        return BITSET_NPOS;
 
-    int b = CHAR_LEN - 1;
-    do {
-        bits[b--] = (c & 1);
-    } while ((c >>= 1) > 0);
-    return bits;
+    size_t i = from / WORD_LEN, nw = BITSET_WORDS(b->len);
+    uint64_t w = ~b->bits[i] & (WORD_ALL << (from % WORD_LEN));
+    while (w == 0) {
+        if (++i >= nw)
+            return BITSET_NPOS;
+        w = ~b->bits[i];
+    }
+    size_t ret = i * WORD_LEN + bitset_ctz64(w);
+    return (ret < b->len) ? ret : BITSET_NPOS;
 }
 
+// Returns the index of the last bit set to 1 at or before a position. 
+//
+// PARAMS: 
+// b    - the bitset to search
+// from - the position to start searching at, going towards 0
+//
+// RET: 
+// The index of the bit, or BITSET_NPOS if there is none. 
+size_t bitset_prev_set(const bitset *b, size_t from) {
+    BITSET_STAT(PREV_SET, sizeof(uint64_t));
+    if (b == NULL || b->bits == NULL)
+        return BITSET_NPOS;
+    if (from >= b->len)
+        from = b->len - 1;
+
+    size_t i = from / WORD_LEN, off = from % WORD_LEN;
+    uint64_t w = b->bits[i] & (WORD_ALL >> (WORD_LEN - 1 - off));
+    while (w == 0) {
+        if (i-- == 0)
+            return BITSET_NPOS;
+        w = b->bits[i];
+    }
+    return i * WORD_LEN + (WORD_LEN - 1 - bitset_clz64(w));
+}
+
+// Calls a function with the index of every bit set to 1, in increasing 
+// order, until the function returns false. 
+//
+// PARAMS: 
+// b   - the bitset to iterate
+// fn  - the function to call
+// ctx - the context passed to the function
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_foreach(const bitset *b, bitset_visit fn, void *ctx) {
+    BITSET_STAT(FOREACH, STAT_BYTES(b, 1));
+    if (b == NULL || b->bits == NULL || fn == NULL)
+        return BITSET_NULL_ERR;
+
+    for (size_t i = 0; i < BITSET_WORDS(b->len); i++) {
+        for (uint64_t w = b->bits[i]; w != 0; w &= w - 1)
+            if (!fn(i * WORD_LEN + bitset_ctz64(w), ctx))
+                return BITSET_GOOD;
+    }
+    return BITSET_GOOD;
+}
+
+// Writes the indices of every bit set to 1, in increasing order. The 
+// bitset must be at most 2^32 bits long. 
+//
+// PARAMS: 
+// b   - the bitset to decode
+// out - the output array, with room for bitset_true_len(b) indices
+//
+// RET: 
+// The number of indices written, 0 on error. 
+size_t bitset_to_indices(const bitset *b, uint32_t *out) {
+    BITSET_STAT(TO_INDICES, STAT_BYTES(b, 1));
+    if (b == NULL || b->bits == NULL || out == NULL)
+        return 0;
+    if (b->len - 1 > UINT32_MAX)
+        return 0;
+    return bitset_kernel->to_indices(b->bits, BITSET_WORDS(b->len), out);
+}
+
+// Returns the number of bits set to 1. 
+//
+// PARAMS: 
+// b - the bitset to check
+//
+// RET: 
+// The number of bits that is set to 1. 
+size_t bitset_true_len(const bitset *b) {
+    BITSET_STAT(TRUE_LEN, STAT_BYTES(b, 1));
+    if (b == NULL || b->bits == NULL)
+        return 0;
+    if (b->cache != NULL) {
+        cache_update(b);
+        return b->cache->count;
+    }
+
+    return bitset_kernel->popcount(b->bits, BITSET_WORDS(b->len));
+}
+
+// Starts caching the number of bits set to 1 in the specified bitset. 
+// Single bit changes then update the cached count directly, other changes 
+// mark the blocks they touch, and bitset_true_len only recounts the marked 
+// blocks. Does nothing if the count is already cached. 
+//
+// PARAMS: 
+// b - the bitset to cache the count of
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_cache_enable(bitset *b) {
+    if (b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (b->cache != NULL)
+        return BITSET_GOOD;
+
+    b->cache = calloc(1, sizeof *b->cache);
+    if (b->cache == NULL)
+        return BITSET_ALLOC_ERR;
+    int ret = cache_fit(b, b->cap);
+    if (ret != BITSET_GOOD)
+        bitset_cache_disable(b);
+    else
+        bitset_cache_invalidate(b);
+    return ret;
+}
+
+// Stops caching the number of bits set to 1 in the specified bitset, 
+// freeing the cache. 
+//
+// PARAMS: 
+// b - the bitset to stop caching the count of
+void bitset_cache_disable(bitset *b) {
+    if (b != NULL && b->cache != NULL) {
+        free(b->cache->counts);
+        free(b->cache->dirty);
+        free(b->cache);
+        b->cache = NULL;
+    }
+}
+
+// Marks the cached count of the specified bitset as out of date, so that 
+// the next bitset_true_len recounts every block. Used after changing the 
+// bits directly. Does nothing if the count is not cached. 
+//
+// PARAMS: 
+// b - the bitset to invalidate
+void bitset_cache_invalidate(bitset *b) {
+    if (b != NULL && b->bits != NULL)
+        cache_mark(b, 0, b->cap);
+}
+
+// Determines whether every bit in the bitset is set to 1. 
+//
+// PARAMS: 
+// b - the bitset to test
+//
+// RET: 
+// True or false depending on whether every bit is set to 1. 
+_Bool bitset_all(const bitset *b) {
+    BITSET_STAT(ALL, STAT_BYTES(b, 1));
+    if (b == NULL || b->bits == NULL)
+        return false;
+
+    size_t last = BITSET_WORDS(b->len) - 1;
+    return b->bits[last] == tail_mask(b->len)
+        && bitset_kernel->all_words(b->bits, last);
+}
+
+// Determines whether any bit in the bitset is set to 1. 
+//
+// PARAMS: 
+// b - the bitset to test
+//
+// RET: 
+// True or false depending on whether any bit is set to 1. 
+_Bool bitset_any(const bitset *b) {
+    BITSET_STAT(ANY, STAT_BYTES(b, 1));
+    if (b == NULL || b->bits == NULL)
+        return false;
+
+    return bitset_kernel->any_words(b->bits, BITSET_WORDS(b->len));
+}
+
+// Determines whether two bitsets have any bit set to 1 in common. 
+//
+// PARAMS: 
+// a - the first bitset
+// b - the second bitset
+//
+// RET: 
+// True or false depending on whether any bit is set to 1 in both bitsets. 
+_Bool bitset_intersects(const bitset *a, const bitset *b) {
+    BITSET_STAT(INTERSECTS, STAT_BYTES(a, 2));
+    if (check_binary(a, b) != BITSET_GOOD)
+        return false;
+    return bitset_kernel->and_any(a->bits, b->bits, BITSET_WORDS(a->len));
+}
+
+// Determines whether every bit set to 1 in a bitset is also set to 1 in 
+// another. 
+//
+// PARAMS: 
+// a - the possible subset
+// b - the possible superset
+//
+// RET: 
+// True or false depending on whether a is a subset of b. 
+_Bool bitset_is_subset(const bitset *a, const bitset *b) {
+    BITSET_STAT(IS_SUBSET, STAT_BYTES(a, 2));
+    if (check_binary(a, b) != BITSET_GOOD)
+        return false;
+    return !bitset_kernel->andnot_any(a->bits, b->bits, BITSET_WORDS(a->len));
+}
+
+// Performs AND operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_and(bitset *lhs, const bitset *rhs) {
+    BITSET_STAT(AND, STAT_BYTES(lhs, 3));
+    if (lhs == NULL || rhs == NULL || lhs->bits == NULL || rhs->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (lhs->len != rhs->len)
+        return BITSET_LENGTH_ERR;
+
+    bitset_kernel->and_words(lhs->bits, lhs->bits, rhs->bits,
+            BITSET_WORDS(lhs->len));
+    cache_mark(lhs, 0, BITSET_WORDS(lhs->len));
+    return BITSET_GOOD;
+}
+
+// Performs OR operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_or(bitset *lhs, const bitset *rhs) {
+    BITSET_STAT(OR, STAT_BYTES(lhs, 3));
+    if (lhs == NULL || rhs == NULL || lhs->bits == NULL || rhs->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (lhs->len != rhs->len)
+        return BITSET_LENGTH_ERR;
+
+    bitset_kernel->or_words(lhs->bits, lhs->bits, rhs->bits,
+            BITSET_WORDS(lhs->len));
+    cache_mark(lhs, 0, BITSET_WORDS(lhs->len));
+    return BITSET_GOOD;
+}
+
+// Performs XOR operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_xor(bitset *lhs, const bitset *rhs) {
+    BITSET_STAT(XOR, STAT_BYTES(lhs, 3));
+    if (lhs == NULL || rhs == NULL || lhs->bits == NULL || rhs->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (lhs->len != rhs->len)
+        return BITSET_LENGTH_ERR;
+
+    bitset_kernel->xor_words(lhs->bits, lhs->bits, rhs->bits,
+            BITSET_WORDS(lhs->len));
+    cache_mark(lhs, 0, BITSET_WORDS(lhs->len));
+    return BITSET_GOOD;
+}
+
+// Performs AND NOT operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand, used inverted
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_andnot(bitset *lhs, const bitset *rhs) {
+    return bitset_andnot3(lhs, lhs, rhs);
+}
+
+// Performs AND operation, storing output in a separate bitset. The output may 
+// be one of the operands. 
+//
+// PARAMS: 
+// dst - the output bitset, initialised to the same length as the operands
+// a   - the left operand
+// b   - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_and3(bitset *dst, const bitset *a, const bitset *b) {
+    BITSET_STAT(AND3, STAT_BYTES(dst, 3));
+    int ret = check_binary3(dst, a, b);
+    if (ret == BITSET_GOOD) {
+        bitset_kernel->and_words(dst->bits, a->bits, b->bits,
+                BITSET_WORDS(dst->len));
+        cache_mark(dst, 0, BITSET_WORDS(dst->len));
+    }
+    return ret;
+}
+
+// Performs OR operation, storing output in a separate bitset. The output may 
+// be one of the operands. 
+//
+// PARAMS: 
+// dst - the output bitset, initialised to the same length as the operands
+// a   - the left operand
+// b   - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_or3(bitset *dst, const bitset *a, const bitset *b) {
+    BITSET_STAT(OR3, STAT_BYTES(dst, 3));
+    int ret = check_binary3(dst, a, b);
+    if (ret == BITSET_GOOD) {
+        bitset_kernel->or_words(dst->bits, a->bits, b->bits,
+                BITSET_WORDS(dst->len));
+        cache_mark(dst, 0, BITSET_WORDS(dst->len));
+    }
+    return ret;
+}
+
+// Performs XOR operation, storing output in a separate bitset. The output may 
+// be one of the operands. 
+//
+// PARAMS: 
+// dst - the output bitset, initialised to the same length as the operands
+// a   - the left operand
+// b   - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_xor3(bitset *dst, const bitset *a, const bitset *b) {
+    BITSET_STAT(XOR3, STAT_BYTES(dst, 3));
+    int ret = check_binary3(dst, a, b);
+    if (ret == BITSET_GOOD) {
+        bitset_kernel->xor_words(dst->bits, a->bits, b->bits,
+                BITSET_WORDS(dst->len));
+        cache_mark(dst, 0, BITSET_WORDS(dst->len));
+    }
+    return ret;
+}
+
+// Performs AND NOT operation (a & ~b), storing output in a separate bitset. 
+// The output may be one of the operands. 
+//
+// PARAMS: 
+// dst - the output bitset, initialised to the same length as the operands
+// a   - the left operand
+// b   - the right operand, used inverted
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_andnot3(bitset *dst, const bitset *a, const bitset *b) {
+    BITSET_STAT(ANDNOT3, STAT_BYTES(dst, 3));
+    int ret = check_binary3(dst, a, b);
+    if (ret == BITSET_GOOD) {
+        bitset_kernel->andnot_words(dst->bits, a->bits, b->bits,
+                BITSET_WORDS(dst->len));
+        cache_mark(dst, 0, BITSET_WORDS(dst->len));
+    }
+    return ret;
+}
+
+// Performs AND operation on any number of bitsets, storing output in a 
+// separate bitset. The operands are combined one cache-sized block at a 
+// time, and a block stops reading further operands once it is all 0. The 
+// output may be one of the operands. 
+//
+// PARAMS: 
+// dst  - the output bitset, initialised to the same length as the operands
+// srcs - the operands
+// k    - the number of operands, at least 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_and_many(bitset *dst, const bitset **srcs, size_t k) {
+    BITSET_STAT(AND_MANY, STAT_BYTES(dst, k + 1));
+    int ret = check_many(dst, srcs, k);
+    if (ret == BITSET_GOOD) {
+        many_op(dst, srcs, k, bitset_kernel->and_words, true);
+        cache_mark(dst, 0, BITSET_WORDS(dst->len));
+    }
+    return ret;
+}
+
+// Performs OR operation on any number of bitsets, storing output in a 
+// separate bitset. The operands are combined one cache-sized block at a 
+// time. The output may be one of the operands. 
+//
+// PARAMS: 
+// dst  - the output bitset, initialised to the same length as the operands
+// srcs - the operands
+// k    - the number of operands, at least 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_or_many(bitset *dst, const bitset **srcs, size_t k) {
+    BITSET_STAT(OR_MANY, STAT_BYTES(dst, k + 1));
+    int ret = check_many(dst, srcs, k);
+    if (ret == BITSET_GOOD) {
+        many_op(dst, srcs, k, bitset_kernel->or_words, false);
+        cache_mark(dst, 0, BITSET_WORDS(dst->len));
+    }
+    return ret;
+}
+
+// Performs XOR operation on any number of bitsets, storing output in a 
+// separate bitset. The operands are combined one cache-sized block at a 
+// time. The output may be one of the operands. 
+//
+// PARAMS: 
+// dst  - the output bitset, initialised to the same length as the operands
+// srcs - the operands
+// k    - the number of operands, at least 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_xor_many(bitset *dst, const bitset **srcs, size_t k) {
+    BITSET_STAT(XOR_MANY, STAT_BYTES(dst, k + 1));
+    int ret = check_many(dst, srcs, k);
+    if (ret == BITSET_GOOD) {
+        many_op(dst, srcs, k, bitset_kernel->xor_words, false);
+        cache_mark(dst, 0, BITSET_WORDS(dst->len));
+    }
+    return ret;
+}
+
+// Finds the bits set to 1 in at least t of any number of bitsets, storing 
+// output in a separate bitset. Each bit is counted with a bit-sliced 
+// counter, one word of counter per bit of the count. The output may be one 
+// of the operands. 
+//
+// PARAMS: 
+// dst  - the output bitset, initialised to the same length as the operands
+// srcs - the operands
+// k    - the number of operands, at least 1
+// t    - the number of operands a bit must be set to 1 in
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_threshold_many(bitset *dst, const bitset **srcs, size_t k,
+        size_t t) {
+    BITSET_STAT(THRESHOLD_MANY, STAT_BYTES(dst, k + 1));
+    int ret = check_many(dst, srcs, k);
+    if (ret != BITSET_GOOD)
+        return ret;
+
+    size_t nw = BITSET_WORDS(dst->len);
+    if (t == 0 || t > k) {
+        memset(dst->bits, (t == 0) ? 0xFF : 0, nw * sizeof(uint64_t));
+        dst->bits[nw - 1] &= tail_mask(dst->len);
+    } else if (t == 1) {
+        many_op(dst, srcs, k, bitset_kernel->or_words, false);
+    } else if (t == k) {
+        many_op(dst, srcs, k, bitset_kernel->and_words, true);
+    } else {
+        uint64_t out[SLICE_WORDS];
+        for (size_t i = 0; i < nw; i += SLICE_WORDS) {
+            size_t n = (nw - i < SLICE_WORDS) ? nw - i : SLICE_WORDS;
+            threshold_block(out, srcs, k, t, i, n);
+            memcpy(dst->bits + i, out, n * sizeof(uint64_t));
+        }
+    }
+    cache_mark(dst, 0, nw);
+    return BITSET_GOOD;
+}
+
+// Returns the number of bits set to 1 in the AND of two bitsets, without 
+// storing the result. 
+//
+// PARAMS: 
+// a - the left operand
+// b - the right operand
+//
+// RET: 
+// The number of bits set to 1, or 0 on error. 
+size_t bitset_and_count(const bitset *a, const bitset *b) {
+    BITSET_STAT(AND_COUNT, STAT_BYTES(a, 2));
+    if (check_binary(a, b) != BITSET_GOOD)
+        return 0;
+    return bitset_kernel->and_count(a->bits, b->bits, BITSET_WORDS(a->len));
+}
+
+// Returns the number of bits set to 1 in the OR of two bitsets, without 
+// storing the result. 
+//
+// PARAMS: 
+// a - the left operand
+// b - the right operand
+//
+// RET: 
+// The number of bits set to 1, or 0 on error. 
+size_t bitset_or_count(const bitset *a, const bitset *b) {
+    BITSET_STAT(OR_COUNT, STAT_BYTES(a, 2));
+    if (check_binary(a, b) != BITSET_GOOD)
+        return 0;
+    return bitset_kernel->or_count(a->bits, b->bits, BITSET_WORDS(a->len));
+}
+
+// Returns the number of bits set to 1 in the XOR of two bitsets, without 
+// storing the result. 
+//
+// PARAMS: 
+// a - the left operand
+// b - the right operand
+//
+// RET: 
+// The number of bits set to 1, or 0 on error. 
+size_t bitset_xor_count(const bitset *a, const bitset *b) {
+    BITSET_STAT(XOR_COUNT, STAT_BYTES(a, 2));
+    if (check_binary(a, b) != BITSET_GOOD)
+        return 0;
+    return bitset_kernel->xor_count(a->bits, b->bits, BITSET_WORDS(a->len));
+}
+
+// Returns the number of bits set to 1 in the AND NOT (a & ~b) of two 
+// bitsets, without storing the result. 
+//
+// PARAMS: 
+// a - the left operand
+// b - the right operand, used inverted
+//
+// RET: 
+// The number of bits set to 1, or 0 on error. 
+size_t bitset_andnot_count(const bitset *a, const bitset *b) {
+    BITSET_STAT(ANDNOT_COUNT, STAT_BYTES(a, 2));
+    if (check_binary(a, b) != BITSET_GOOD)
+        return 0;
+    return bitset_kernel->andnot_count(a->bits, b->bits, BITSET_WORDS(a->len));
+}
+
+// Performs NOT operation. 
+//
+// PARAMS: 
+// b - the bitset to perform NOT
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_not(bitset *b) {
+    BITSET_STAT(NOT, STAT_BYTES(b, 2));
+    if (b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+
+    size_t nw = BITSET_WORDS(b->len);
+    bitset_kernel->not_words(b->bits, nw);
+    b->bits[nw - 1] &= tail_mask(b->len);
+    cache_mark(b, 0, nw);
+    return BITSET_GOOD;
+}
+
+// Performs left shift. 
+//
+// PARAMS: 
+// b - the bitset to left shift
+// n - the number of shifts
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_lsh(bitset *b, size_t n) {
+    BITSET_STAT(LSH, STAT_BYTES(b, 2));
+    if (b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (n == 0)
+        return BITSET_GOOD;     // no shifts needed
+
+    size_t nw = BITSET_WORDS(b->len);
+    if (n >= b->len) {
+        memset(b->bits, 0, nw * sizeof(uint64_t));
+    } else {
+        size_t q = n / WORD_LEN, r = n % WORD_LEN;
+        size_t sh = nw - q;     // shift length in words
+        uint64_t *w = b->bits;
+        if (r == 0) {
+            memmove(w, w + q, sh * sizeof(uint64_t));
+        } else {
+            for (size_t i = 0; i + 1 < sh; i++)
+                w[i] = (w[i + q] >> r) | (w[i + q + 1] << (WORD_LEN - r));
+            w[sh - 1] = w[nw - 1] >> r;
+        }
+        memset(w + sh, 0, q * sizeof(uint64_t));
+    }
+    cache_mark(b, 0, nw);
+    return BITSET_GOOD;
+}
+
+// Performs right shift. 
+//
+// PARAMS: 
+// b - the bitset to right shift
+// n - the number of shifts
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_rsh(bitset *b, size_t n) {
+    BITSET_STAT(RSH, STAT_BYTES(b, 2));
+    if (b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (n == 0)
+        return BITSET_GOOD;     // no shifts needed
+
+    size_t nw = BITSET_WORDS(b->len);
+    if (n >= b->len) {
+        memset(b->bits, 0, nw * sizeof(uint64_t));
+    } else {
+        size_t q = n / WORD_LEN, r = n % WORD_LEN;
+        size_t sh = nw - q;     // shift length in words
+        uint64_t *w = b->bits;
+        if (r == 0) {
+            memmove(w + q, w, sh * sizeof(uint64_t));
+        } else {
+            for (size_t i = nw - 1; i > q; i--)
+                w[i] = (w[i - q] << r) | (w[i - q - 1] >> (WORD_LEN - r));
+            w[q] = w[0] << r;
+        }
+        memset(w, 0, q * sizeof(uint64_t));
+        w[nw - 1] &= tail_mask(b->len);
+    }
+    cache_mark(b, 0, nw);
+    return BITSET_GOOD;
+}
+
+// Performs left rotate. 
+//
+// PARAMS: 
+// b - the bitset to left rotate
+// n - the number of shifts
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_lrot(bitset *b, size_t n) {
+    BITSET_STAT(LROT, STAT_BYTES(b, 2));
+    if (b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (n % b->len == 0)
+        return BITSET_GOOD;     // no need to rotate
+
+    bits_rotate(b->bits, b->len, n % b->len);
+    cache_mark(b, 0, BITSET_WORDS(b->len));
+    return BITSET_GOOD;
+}
+
+// Performs right rotate. 
+//
+// PARAMS: 
+// b - the bitset to right rotate
+// n - the number of shifts
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_rrot(bitset *b, size_t n) {
+    BITSET_STAT(RROT, STAT_BYTES(b, 2));
+    if (b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (n % b->len == 0)
+        return BITSET_GOOD;     // no need to rotate
+
+    bits_rotate(b->bits, b->len, b->len - n % b->len);
+    cache_mark(b, 0, BITSET_WORDS(b->len));
+    return BITSET_GOOD;
+}
+
+// Resets the bitset, changing all bits to 0. 
+//
+// PARAMS: 
+// b - the bitset to reset
+void bitset_reset(bitset *b) {
+    BITSET_STAT(RESET, STAT_BYTES(b, 1));
+    if (b != NULL && b->bits != NULL) {
+        memset(b->bits, 0, BITSET_WORDS(b->len) * sizeof(uint64_t));
+        if (b->cache != NULL) {
+            struct bitset_cache_t *c = b->cache;
+            memset(c->counts, 0, c->nblocks * sizeof(uint32_t));
+            memset(c->dirty, 0, BITSET_WORDS(c->nblocks) * sizeof(uint64_t));
+            c->count = 0;
+            c->stale = false;
+        }
+    }
+}
+
+// Frees the internal storage of the given bitset. 
+//
+// PARAMS: 
+// b - the bitset to free
+void bitset_free(bitset *b) {
+    BITSET_STAT(FREE, 0);
+    if (b != NULL) {
+        if (b->alloc == NULL)
+            free(b->bits);
+        else if (b->bits != NULL)
+            b->alloc->release(b->bits, b->cap * sizeof(uint64_t),
+                    b->alloc->ctx);
+        b->bits = NULL;
+        bitset_cache_disable(b);
+    }
+}
+
+// Allocates the zeroed bits of a bitset from an allocator. 
+//
+// PARAMS: 
+// b     - the bitset to allocate bits for
+// n     - the length of the bitset
+// alloc - the allocator to use, or NULL for malloc
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int alloc_bits(bitset *b, size_t n, const bitset_allocator *alloc) {
+    if (n > SIZE_MAX - WORD_LEN)
+        return BITSET_LENGTH_ERR;       // BITSET_WORDS(n) would wrap to 0
+
+    size_t size = BITSET_WORDS(n) * sizeof(uint64_t);
+    b->len = n;
+    b->alloc = alloc;
+    b->cap = BITSET_WORDS(n);
+    b->cache = NULL;
+    if (alloc == NULL) {
+        b->bits = calloc(BITSET_WORDS(n), sizeof(uint64_t));
+    } else {
+        b->bits = alloc->alloc(size, alloc->ctx);
+        if (b->bits != NULL)
+            memset(b->bits, 0, size);
+    }
+    if (b->bits == NULL)
+        return BITSET_ALLOC_ERR;
+    BITSET_STAT_ALLOC(size);
+    return BITSET_GOOD;
+}
+
+// Grows the capacity of a bitset, keeping its bits and zeroing the new 
+// words. Borrowed memory is replaced with heap memory. 
+//
+// PARAMS: 
+// b     - the bitset to grow
+// words - the new capacity in words
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int grow(bitset *b, size_t words) {
+    if (words > SIZE_MAX / sizeof(uint64_t)
+            || cache_fit(b, words) != BITSET_GOOD)
+        return BITSET_ALLOC_ERR;
+
+    uint64_t *bits;
+    size_t size = words * sizeof(uint64_t), used = b->cap * sizeof(uint64_t);
+    if (b->alloc == NULL) {
+        bits = realloc(b->bits, size);          // grows in place if it can
+        if (bits == NULL)
+            return BITSET_ALLOC_ERR;
+    } else {
+        const bitset_allocator *alloc = (b->alloc->alloc == NULL)
+            ? NULL : b->alloc;      // borrowed bits move to the heap
+        bits = (alloc == NULL) ? malloc(size) : alloc->alloc(size, alloc->ctx);
+        if (bits == NULL)
+            return BITSET_ALLOC_ERR;
+        memcpy(bits, b->bits, used);
+        b->alloc->release(b->bits, used, b->alloc->ctx);
+        b->alloc = alloc;
+    }
+    memset((char *)bits + used, 0, size - used);
+    b->bits = bits;
+    b->cap = words;
+    BITSET_STAT_ALLOC(size);
+    return BITSET_GOOD;
+}
+
+// Releases borrowed memory, which is left to its owner. 
+//
+// PARAMS: 
+// p    - the memory to release
+// size - the size of the memory
+// ctx  - unused
+static void borrowed_release(void *p, size_t size, void *ctx) {
+    (void)p;
+    (void)size;
+    (void)ctx;
+}
+
+// Grows the cache of a bitset to cover a capacity. The new blocks are 
+// counted as 0, which matches the zeroed words they will cover. 
+//
+// PARAMS: 
+// b     - the bitset to grow the cache of
+// words - the capacity in words to cover
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int cache_fit(bitset *b, size_t words) {
+    struct bitset_cache_t *c = b->cache;
+    size_t n = words / CACHE_WORDS + (words % CACHE_WORDS != 0);
+    if (c == NULL || n <= c->nblocks)
+        return BITSET_GOOD;
+
+    uint32_t *counts = realloc(c->counts, n * sizeof(uint32_t));
+    if (counts == NULL)
+        return BITSET_ALLOC_ERR;
+    c->counts = counts;
+    uint64_t *dirty = realloc(c->dirty, BITSET_WORDS(n) * sizeof(uint64_t));
+    if (dirty == NULL)
+        return BITSET_ALLOC_ERR;
+    c->dirty = dirty;
+
+    size_t used = BITSET_WORDS(c->nblocks);
+    memset(counts + c->nblocks, 0, (n - c->nblocks) * sizeof(uint32_t));
+    memset(dirty + used, 0, (BITSET_WORDS(n) - used) * sizeof(uint64_t));
+    c->nblocks = n;
+    return BITSET_GOOD;
+}
+
+// Updates the cached count of a bitset for a bit about to be changed. 
+//
+// PARAMS: 
+// b - the bitset being changed
+// i - the index of the bit
+// v - the new value of the bit
+static void cache_bit(const bitset *b, size_t i, _Bool v) {
+    struct bitset_cache_t *c = b->cache;
+    if (c == NULL || bitset_test(b, i) == v)
+        return;
+
+    size_t k = i / WORD_LEN / CACHE_WORDS;
+    if (v) {
+        c->counts[k]++;
+        c->count++;
+    } else {
+        c->counts[k]--;
+        c->count--;
+    }
+}
+
+// Marks the cached blocks covering a range of words for a recount. 
+//
+// PARAMS: 
+// b  - the bitset that changed
+// lo - the first word changed
+// hi - one past the last word changed
+static void cache_mark(const bitset *b, size_t lo, size_t hi) {
+    struct bitset_cache_t *c = b->cache;
+    if (c == NULL || lo >= hi)
+        return;
+
+    size_t first = lo / CACHE_WORDS, last = (hi - 1) / CACHE_WORDS;
+    if (last >= c->nblocks)
+        last = c->nblocks - 1;
+    range_op(c->dirty, first, last - first + 1, RANGE_SET);
+    c->stale = true;
+}
+
+// Marks the cached blocks holding some bits for a recount. 
+//
+// PARAMS: 
+// b     - the bitset that changed
+// idx   - the indices of the changed bits
+// count - the number of indices
+static void cache_indices(const bitset *b, const size_t *idx, size_t count) {
+    struct bitset_cache_t *c = b->cache;
+    if (c == NULL || count == 0)
+        return;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t k = idx[i] / WORD_LEN / CACHE_WORDS;
+        c->dirty[k / WORD_LEN] |= BIT_MASK(k);
+    }
+    c->stale = true;
+}
+
+// Recounts the cached blocks marked since the last update. Every bit past 
+// the length is 0, so a block is counted up to the capacity. 
+//
+// PARAMS: 
+// b - the bitset to update the cache of
+static void cache_update(const bitset *b) {
+    struct bitset_cache_t *c = b->cache;
+    if (!c->stale)
+        return;
+
+    for (size_t j = 0; j < BITSET_WORDS(c->nblocks); j++) {
+        for (uint64_t d = c->dirty[j]; d != 0; d &= d - 1) {
+            size_t k = j * WORD_LEN + bitset_ctz64(d);
+            size_t lo = k * CACHE_WORDS;
+            size_t n = (b->cap - lo < CACHE_WORDS) ? b->cap - lo : CACHE_WORDS;
+            size_t v = bitset_kernel->popcount(b->bits + lo, n);
+            c->count = c->count - c->counts[k] + v;
+            c->counts[k] = (uint32_t)v;
+        }
+        c->dirty[j] = 0;
+    }
+    c->stale = false;
+}
+
+// Returns the mask of the used bits in the last word of a bitset. 
+//
+// PARAMS: 
+// n - the length of the bitset
+//
+// RET: 
+// The mask of the used bits in the last word. 
+static uint64_t tail_mask(size_t n) {
+    size_t r = n % WORD_LEN;
+    return (r == 0) ? WORD_ALL : ((uint64_t)1 << r) - 1;
+}
+
+// Reads up to 64 bits starting at any bit position. 
+//
+// PARAMS: 
+// w   - the words to read from
+// pos - the first bit to read
+// n   - the number of bits to read, between 1 and 64
+//
+// RET: 
+// The bits read, with the first bit at position 0. 
+static uint64_t bits_get(const uint64_t *w, size_t pos, size_t n) {
+    size_t i = pos / WORD_LEN, off = pos % WORD_LEN;
+    uint64_t v = w[i] >> off;
+    if (off + n > WORD_LEN)
+        v |= w[i + 1] << (WORD_LEN - off);
+    return (n == WORD_LEN) ? v : v & (((uint64_t)1 << n) - 1);
+}
+
+// Writes up to 64 bits starting at any bit position, leaving the bits 
+// around them untouched. 
+//
+// PARAMS: 
+// w   - the words to write to
+// pos - the first bit to write
+// n   - the number of bits to write, between 1 and 64
+// v   - the bits to write, with the first bit at position 0
+static void bits_put(uint64_t *w, size_t pos, size_t n, uint64_t v) {
+    size_t i = pos / WORD_LEN, off = pos % WORD_LEN;
+    uint64_t m = (n == WORD_LEN) ? WORD_ALL : ((uint64_t)1 << n) - 1;
+    v &= m;
+    w[i] = (w[i] & ~(m << off)) | (v << off);
+    if (off + n > WORD_LEN) {
+        uint64_t hi = ((uint64_t)1 << (off + n - WORD_LEN)) - 1;
+        w[i + 1] = (w[i + 1] & ~hi) | (v >> (WORD_LEN - off));
+    }
+}
+
+// Reverses the order of the bits in a word. 
+//
+// PARAMS: 
+// w - the word to reverse
+//
+// RET: 
+// The reversed word. 
+static uint64_t reverse64(uint64_t w) {
+    w = ((w >> 1) & 0x5555555555555555ULL) | ((w & 0x5555555555555555ULL) << 1);
+    w = ((w >> 2) & 0x3333333333333333ULL) | ((w & 0x3333333333333333ULL) << 2);
+    w = ((w >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((w & 0x0F0F0F0F0F0F0F0FULL) << 4);
+#if defined(__GNUC__)
+    return __builtin_bswap64(w);
+#else
+    w = ((w >> 8) & 0x00FF00FF00FF00FFULL) | ((w & 0x00FF00FF00FF00FFULL) << 8);
+    w = ((w >> 16) & 0x0000FFFF0000FFFFULL)
+        | ((w & 0x0000FFFF0000FFFFULL) << 16);
+    return (w >> 32) | (w << 32);
+#endif
+}
+
+// Reverses the order of a range of bits in place, swapping up to 64 bits 
+// from each end at a time. 
+//
+// PARAMS: 
+// w   - the words to change
+// pos - the first bit of the range
+// n   - the number of bits in the range
+static void bits_reverse(uint64_t *w, size_t pos, size_t n) {
+    size_t lo = pos, hi = pos + n;
+    while (hi - lo >= 2) {
+        size_t k = (hi - lo) / 2;
+        if (k > WORD_LEN)
+            k = WORD_LEN;
+        uint64_t a = reverse64(bits_get(w, lo, k)) >> (WORD_LEN - k);
+        uint64_t b = reverse64(bits_get(w, hi - k, k)) >> (WORD_LEN - k);
+        bits_put(w, lo, k, b);
+        bits_put(w, hi - k, k, a);
+        lo += k;
+        hi -= k;
+    }
+}
+
+// Rotates bits towards position 0 in place, without allocating. Bitsets 
+// that fit in a word are rotated directly, longer ones by reversing both 
+// parts and then the whole range. 
+//
+// PARAMS: 
+// w   - the words to rotate
+// len - the number of bits in use
+// n   - the number of shifts, less than len
+static void bits_rotate(uint64_t *w, size_t len, size_t n) {
+    if (n == 0)
+        return;
+    if (len <= WORD_LEN) {
+        w[0] = ((w[0] >> n) | (w[0] << (len - n))) & tail_mask(len);
+    } else {
+        bits_reverse(w, 0, n);
+        bits_reverse(w, n, len - n);
+        bits_reverse(w, 0, len);
+    }
+}
+
+// Sets, clears or inverts a non-empty range of bits. The partial words at 
+// either end are masked, and the whole words between them are filled with 
+// memset or inverted with the NOT kernel. 
+//
+// PARAMS: 
+// w   - the words to change
+// pos - the first bit of the range
+// n   - the number of bits in the range
+// op  - RANGE_SET, RANGE_CLEAR or RANGE_FLIP
+static void range_op(uint64_t *w, size_t pos, size_t n, int op) {
+    size_t i = pos / WORD_LEN, j = (pos + n - 1) / WORD_LEN;
+    uint64_t head = WORD_ALL << (pos % WORD_LEN);
+    uint64_t tail = tail_mask(pos + n);
+    if (i == j)
+        head &= tail;
+
+    if (op == RANGE_SET) {
+        w[i] |= head;
+        if (i != j) {
+            memset(w + i + 1, 0xFF, (j - i - 1) * sizeof(uint64_t));
+            w[j] |= tail;
+        }
+    } else if (op == RANGE_CLEAR) {
+        w[i] &= ~head;
+        if (i != j) {
+            memset(w + i + 1, 0, (j - i - 1) * sizeof(uint64_t));
+            w[j] &= ~tail;
+        }
+    } else {
+        w[i] ^= head;
+        if (i != j) {
+            bitset_kernel->not_words(w + i + 1, j - i - 1);
+            w[j] ^= tail;
+        }
+    }
+}
+
+// Checks a bitset and a bit index. 
+//
+// PARAMS: 
+// b - the bitset to check
+// i - the index of the bit
+//
+// RET: 
+// Zero if the index is within the bitset, non-zero on error. 
+static int check_index(const bitset *b, size_t i) {
+    if (b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (i >= b->len)
+        return BITSET_RANGE_ERR;
+    return BITSET_GOOD;
+}
+
+// Checks a bitset and a range of bits. 
+//
+// PARAMS: 
+// b   - the bitset to check
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// Zero if the range is within the bitset, non-zero on error. 
+static int check_range(const bitset *b, size_t pos, size_t n) {
+    if (b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (pos > b->len || n > b->len - pos)
+        return BITSET_RANGE_ERR;
+    return BITSET_GOOD;
+}
+
+// Checks a bitset and an array of bit indices. 
+//
+// PARAMS: 
+// b     - the bitset to check
+// idx   - the indices of the bits
+// count - the number of indices
+//
+// RET: 
+// Zero if every index is within the bitset, non-zero on error. 
+static int check_indices(const bitset *b, const size_t *idx, size_t count) {
+    if (b == NULL || b->bits == NULL || (idx == NULL && count > 0))
+        return BITSET_NULL_ERR;
+
+    size_t max = 0;
+    for (size_t i = 0; i < count; i++)
+        max = (idx[i] > max) ? idx[i] : max;
+    return (count > 0 && max >= b->len) ? BITSET_RANGE_ERR : BITSET_GOOD;
+}
+
+// Checks the operands of a binary operation. 
+//
+// PARAMS: 
+// a - the left operand
+// b - the right operand
+//
+// RET: 
+// Zero if both operands are usable together, non-zero on error. 
+static int check_binary(const bitset *a, const bitset *b) {
+    if (a == NULL || b == NULL || a->bits == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (a->len != b->len)
+        return BITSET_LENGTH_ERR;
+    return BITSET_GOOD;
+}
+
+// Checks the output and operands of a three-operand binary operation. 
+//
+// PARAMS: 
+// dst - the output bitset
+// a   - the left operand
+// b   - the right operand
+//
+// RET: 
+// Zero if all bitsets are usable together, non-zero on error. 
+static int check_binary3(const bitset *dst, const bitset *a, const bitset *b) {
+    int ret = check_binary(a, b);
+    if (ret == BITSET_GOOD)
+        ret = check_binary(dst, a);
+    return ret;
+}
+
+// Checks the output and operands of an operation on many bitsets. 
+//
+// PARAMS: 
+// dst  - the output bitset
+// srcs - the operands
+// k    - the number of operands
+//
+// RET: 
+// Zero if all bitsets are usable together, non-zero on error. 
+static int check_many(const bitset *dst, const bitset **srcs, size_t k) {
+    if (srcs == NULL)
+        return BITSET_NULL_ERR;
+    if (k == 0)
+        return BITSET_LENGTH_ERR;
+
+    int ret = BITSET_GOOD;
+    for (size_t i = 0; i < k && ret == BITSET_GOOD; i++)
+        ret = check_binary(dst, srcs[i]);
+    return ret;
+}
+
+// Combines many bitsets into an output, one block at a time. Each block is 
+// built in a local buffer, so the output may be one of the operands. 
+//
+// PARAMS: 
+// dst       - the output bitset
+// srcs      - the operands
+// k         - the number of operands
+// fn        - the binary kernel combining two operands
+// stop_zero - whether a block is finished once it is all 0
+static void many_op(bitset *dst, const bitset **srcs, size_t k,
+        void (*fn)(uint64_t *, const uint64_t *, const uint64_t *, size_t),
+        _Bool stop_zero) {
+    uint64_t acc[BLOCK_WORDS];
+    size_t nw = BITSET_WORDS(dst->len);
+    for (size_t i = 0; i < nw; i += BLOCK_WORDS) {
+        size_t n = (nw - i < BLOCK_WORDS) ? nw - i : BLOCK_WORDS;
+        memcpy(acc, srcs[0]->bits + i, n * sizeof(uint64_t));
+        for (size_t j = 1; j < k; j++) {
+            if (stop_zero && !bitset_kernel->any_words(acc, n))
+                break;
+            fn(acc, acc, srcs[j]->bits + i, n);
+        }
+        memcpy(dst->bits + i, acc, n * sizeof(uint64_t));
+    }
+}
+
+// Finds the bits set to 1 in at least t operands for one block of words. 
+// Counts are kept in bit-sliced counters: plane p holds bit p of the count 
+// of every bit, so adding an operand is a ripple-carry add of one word per 
+// plane, stopping as soon as the carry is 0. 
+//
+// PARAMS: 
+// dst  - the output words
+// srcs - the operands
+// k    - the number of operands
+// t    - the number of operands a bit must be set to 1 in
+// off  - the index of the first word of the block
+// n    - the number of words in the block
+static void threshold_block(uint64_t *dst, const bitset **srcs, size_t k,
+        size_t t, size_t off, size_t n) {
+    uint64_t planes[WORD_LEN][SLICE_WORDS];
+    size_t np = WORD_LEN - bitset_clz64((uint64_t)k);
+    for (size_t p = 0; p < np; p++)
+        memset(planes[p], 0, n * sizeof(uint64_t));
+    for (size_t j = 0; j < k; j++) {
+        const uint64_t *w = srcs[j]->bits + off;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t carry = w[i];
+            for (size_t p = 0; p < np && carry != 0; p++) {
+                uint64_t c = planes[p][i] & carry;
+                planes[p][i] ^= carry;
+                carry = c;
+            }
+        }
+    }
+
+    // compare every count against t, from the most significant plane
+    for (size_t i = 0; i < n; i++) {
+        uint64_t gt = 0, eq = WORD_ALL;
+        for (size_t p = np; p-- > 0; ) {
+            if ((t >> p) & 1) {
+                eq &= planes[p][i];
+            } else {
+                gt |= eq & planes[p][i];
+                eq &= ~planes[p][i];
+            }
+        }
+        dst[i] = gt | eq;
+    }
+}
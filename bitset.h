@@ -10,19 +10,206 @@
 #define BITSET_H
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define BITSET_GOOD 0
 #define BITSET_NULL_ERR 1
 #define BITSET_ALLOC_ERR 2
 #define BITSET_LENGTH_ERR 3
+#define BITSET_RANGE_ERR 4
+#define BITSET_IO_ERR 5
+#define BITSET_FORMAT_ERR 6
+
+#define BITSET_NPOS SIZE_MAX
 
-// The bitset type. 
+#define BITSET_WORD_LEN 64
+
+// Returns the number of words needed to store n bits. 
+#define BITSET_WORDS(n) (((n) + BITSET_WORD_LEN - 1) / BITSET_WORD_LEN)
+
+// Number of words stored inside the bitset itself by bitset_init_inline. 
+// Define as 4 before including this header for 256-bit inline bitsets. 
+#ifndef BITSET_INLINE_WORDS
+#define BITSET_INLINE_WORDS 2
+#endif
+#define BITSET_INLINE_LEN (BITSET_INLINE_WORDS * BITSET_WORD_LEN)
+
+// The allocator type, used for the internal bits of a bitset. The 
+// allocator must outlive every bitset using it. An allocator without alloc 
+// lends bits it owns: copies and grown bitsets take their bits from the 
+// heap instead, and release is called once the bits are given up. 
+typedef struct bitset_allocator_t {
+    // allocates size bytes aligned to at least 8 bytes, or returns NULL
+    void *(*alloc)(size_t size, void *ctx);
+
+    // releases memory returned by alloc, with the size it was asked for
+    void (*release)(void *p, size_t size, void *ctx);
+    void *ctx;      // passed to the callbacks
+} bitset_allocator;
+
+// The bitset type. Bit i is stored in word i / 64 at position i % 64, and 
+// the unused bits of the last word are always kept at 0. An inline bitset 
+// points into itself, so it must not be copied or moved by assignment, 
+// only with bitset_copy or bitset_move. 
+// The unchecked inline accessors below do not update a cached count, so 
+// call bitset_cache_invalidate after using them on a cached bitset. 
 typedef struct bitset_t {
-    _Bool *bits;    // internal bits
-    size_t len;     // length
+    uint64_t *bits; // internal bits, packed into words
+    size_t len;     // length in bits
+    const bitset_allocator *alloc;  // allocator of bits, NULL for malloc
+    size_t cap;     // capacity in words, with every bit past len at 0
+    uint64_t small[BITSET_INLINE_WORDS];    // bits of an inline bitset
+    struct bitset_cache_t *cache;   // cached count, NULL unless enabled
 } bitset;
 
+// The set bit iterator type. 
+typedef struct bitset_iter_t {
+    const uint64_t *bits;   // words being iterated
+    size_t nwords;          // number of words
+    size_t word;            // index of the current word
+    uint64_t rest;          // bits of the current word not yet returned
+} bitset_iter;
+
+// The callback type used by bitset_foreach. Returns true to continue. 
+typedef _Bool (*bitset_visit)(size_t i, void *ctx);
+
+// Returns the number of trailing 0 bits in a word. 
+//
+// PARAMS: 
+// w - the word to count, must not be 0
+//
+// RET: 
+// The index of the lowest bit set to 1. 
+static inline unsigned bitset_ctz64(uint64_t w) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(w);
+#else
+    static const unsigned char pos[64] = {
+        0, 1, 2, 53, 3, 7, 54, 27, 4, 38, 41, 8, 34, 55, 48, 28,
+        62, 5, 39, 46, 44, 42, 22, 9, 24, 35, 59, 56, 49, 18, 29, 11,
+        63, 52, 6, 26, 37, 40, 33, 47, 61, 45, 43, 21, 23, 58, 17, 10,
+        51, 25, 36, 32, 60, 20, 57, 16, 50, 31, 19, 15, 30, 14, 13, 12
+    };
+    return pos[((w & (0 - w)) * 0x022FDD63CC95386DULL) >> 58];
+#endif
+}
+
+// Returns the number of leading 0 bits in a word. 
+//
+// PARAMS: 
+// w - the word to count, must not be 0
+//
+// RET: 
+// 63 minus the index of the highest bit set to 1. 
+static inline unsigned bitset_clz64(uint64_t w) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_clzll(w);
+#else
+    unsigned n = 0;
+    while (!(w & ((uint64_t)1 << 63))) {
+        w <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Returns the number of bits set to 1 in a word. 
+//
+// PARAMS: 
+// w - the word to count
+//
+// RET: 
+// The number of bits set to 1. 
+static inline size_t bitset_popcount64(uint64_t w) {
+#if defined(__GNUC__)
+    return (size_t)__builtin_popcountll(w);
+#else
+    w = w - ((w >> 1) & 0x5555555555555555ULL);
+    w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+    w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (size_t)((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Changes the specified bit to 1. Does not check the bitset or the index. 
+//
+// PARAMS: 
+// b - the bitset to change
+// i - the index of the bit, less than the length of the bitset
+static inline void bitset_set(bitset *b, size_t i) {
+    b->bits[i / BITSET_WORD_LEN] |= (uint64_t)1 << (i % BITSET_WORD_LEN);
+}
+
+// Changes the specified bit to 0. Does not check the bitset or the index. 
+//
+// PARAMS: 
+// b - the bitset to change
+// i - the index of the bit, less than the length of the bitset
+static inline void bitset_clear(bitset *b, size_t i) {
+    b->bits[i / BITSET_WORD_LEN] &= ~((uint64_t)1 << (i % BITSET_WORD_LEN));
+}
+
+// Inverts the specified bit. Does not check the bitset or the index. 
+//
+// PARAMS: 
+// b - the bitset to change
+// i - the index of the bit, less than the length of the bitset
+static inline void bitset_flip(bitset *b, size_t i) {
+    b->bits[i / BITSET_WORD_LEN] ^= (uint64_t)1 << (i % BITSET_WORD_LEN);
+}
+
+// Determines whether the specified bit is set to 1. Does not check the 
+// bitset or the index. 
+//
+// PARAMS: 
+// b - the bitset to test
+// i - the index of the bit, less than the length of the bitset
+//
+// RET: 
+// True or false depending on whether the bit is set to 1. 
+static inline _Bool bitset_test(const bitset *b, size_t i) {
+    return (b->bits[i / BITSET_WORD_LEN] >> (i % BITSET_WORD_LEN)) & 1;
+}
+
+// Initialises an iterator over the bits set to 1, in increasing order. The 
+// bitset must not be changed while it is iterated. Does not check the 
+// bitset. 
+//
+// PARAMS: 
+// it - the iterator to initialise
+// b  - the bitset to iterate
+static inline void bitset_iter_init(bitset_iter *it, const bitset *b) {
+    it->bits = b->bits;
+    it->nwords = BITSET_WORDS(b->len);
+    it->word = 0;
+    it->rest = b->bits[0];
+}
+
+// Advances an iterator to the next bit set to 1. 
+//
+// PARAMS: 
+// it - the iterator to advance
+// i  - the index of the next bit set to 1
+//
+// RET: 
+// True if a bit was found, false once every bit has been returned. 
+static inline _Bool bitset_iter_next(bitset_iter *it, size_t *i) {
+    while (it->rest == 0) {
+        if (it->word + 1 >= it->nwords)
+            return false;
+        it->rest = it->bits[++it->word];
+    }
+    *i = it->word * BITSET_WORD_LEN + bitset_ctz64(it->rest);
+    it->rest &= it->rest - 1;
+    return true;
+}
+
 // Initialises the specified bitset. 
 //
 // PARAMS: 
@@ -56,6 +243,340 @@ int bitset_init_bstr(bitset *b, const char *str, size_t n);
 // Zero on success, non-zero on error. 
 int bitset_init_str(bitset *b, const char *str, size_t n);
 
+// Initialises the specified bitset, allocating its bits from an allocator. 
+//
+// PARAMS: 
+// b     - the bitset to initialise
+// n     - the length of the bitset
+// alloc - the allocator to use, or NULL for malloc
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_init_alloc(bitset *b, size_t n, const bitset_allocator *alloc);
+
+// Initialises the specified bitset on caller-provided memory, without 
+// allocating. Every bit is set to 0. The memory must stay valid while the 
+// bitset is used, and freeing the bitset leaves it alone. 
+//
+// PARAMS: 
+// b   - the bitset to initialise
+// mem - the memory to use, 8-byte aligned and BITSET_WORDS(n) words long
+// n   - the length of the bitset
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_init_buffer(bitset *b, void *mem, size_t n);
+
+// Initialises the specified bitset with its bits stored inside the bitset 
+// itself, without allocating. The bitset must not be copied or moved by 
+// assignment afterwards. 
+//
+// PARAMS: 
+// b - the bitset to initialise
+// n - the length of the bitset, at most BITSET_INLINE_LEN
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_init_inline(bitset *b, size_t n);
+
+// Initialises the specified bitset from a bit string, allocating its bits 
+// from an allocator. 
+//
+// PARAMS: 
+// b     - the bitset to initialise
+// str   - the bit string to initialise
+// n     - the length of the bit string
+// alloc - the allocator to use, or NULL for malloc
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_init_bstr_alloc(bitset *b, const char *str, size_t n,
+        const bitset_allocator *alloc);
+
+// Initialises the specified bitset from a string, allocating its bits from 
+// an allocator. Each character will take 8 bits. 
+//
+// PARAMS: 
+// b     - the bitset to initialise
+// str   - the string to initialise
+// n     - the length of the string
+// alloc - the allocator to use, or NULL for malloc
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_init_str_alloc(bitset *b, const char *str, size_t n,
+        const bitset_allocator *alloc);
+
+// Initialises a bitset as a copy of another, with its bits from the same 
+// allocator. Bits in borrowed or inline memory are copied to the heap, and 
+// a cached count is not copied. 
+//
+// PARAMS: 
+// dst - the bitset to initialise, not holding any bits
+// src - the bitset to copy
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_copy(bitset *dst, const bitset *src);
+
+// Moves the bits of a bitset to another without copying them, leaving the 
+// source freed. Inline bits are copied into the destination. 
+//
+// PARAMS: 
+// dst - the bitset to move to, not holding any bits
+// src - the bitset to move from
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_move(bitset *dst, bitset *src);
+
+// Swaps the bits of two bitsets without copying them, other than inline 
+// bits. 
+//
+// PARAMS: 
+// a - the first bitset
+// b - the second bitset
+void bitset_swap(bitset *a, bitset *b);
+
+// Writes the bitset as a bit string of '0' and '1' characters, followed by 
+// a NUL. 
+//
+// PARAMS: 
+// b   - the bitset to write
+// buf - the output buffer, with room for the length of the bitset plus 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_to_bstr(const bitset *b, char *buf);
+
+// Makes sure the specified bitset can grow to a length without allocating. 
+// Memory from bitset_init_buffer or bitset_init_inline is moved to the heap 
+// when it is too small. 
+//
+// PARAMS: 
+// b - the bitset to reserve for
+// n - the length in bits to make room for
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_reserve(bitset *b, size_t n);
+
+// Changes the length of the specified bitset. New bits are set to 0, and 
+// the capacity grows geometrically so that repeated growth is amortised. 
+//
+// PARAMS: 
+// b - the bitset to resize
+// n - the new length of the bitset
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_resize(bitset *b, size_t n);
+
+// Appends a bit to the end of the specified bitset. 
+//
+// PARAMS: 
+// b - the bitset to append to
+// v - the value of the new bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_push_back(bitset *b, _Bool v);
+
+// Appends the bits of a bitset to the end of another. The bitsets may be 
+// the same. 
+//
+// PARAMS: 
+// b   - the bitset to append to
+// src - the bitset to append
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_append(bitset *b, const bitset *src);
+
+// Changes the specified bit to 1. 
+//
+// PARAMS: 
+// b - the bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_set_checked(bitset *b, size_t i);
+
+// Changes the specified bit to 0. 
+//
+// PARAMS: 
+// b - the bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_clear_checked(bitset *b, size_t i);
+
+// Inverts the specified bit. 
+//
+// PARAMS: 
+// b - the bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_flip_checked(bitset *b, size_t i);
+
+// Determines whether the specified bit is set to 1. 
+//
+// PARAMS: 
+// b - the bitset to test
+// i - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit is set to 1. False on error. 
+_Bool bitset_test_checked(const bitset *b, size_t i);
+
+// Changes the specified bits to 1. Nothing is changed if any index is out 
+// of range. 
+//
+// PARAMS: 
+// b     - the bitset to change
+// idx   - the indices of the bits
+// count - the number of indices
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_set_many(bitset *b, const size_t *idx, size_t count);
+
+// Changes the specified bits to 0. Nothing is changed if any index is out 
+// of range. 
+//
+// PARAMS: 
+// b     - the bitset to change
+// idx   - the indices of the bits
+// count - the number of indices
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_clear_many(bitset *b, const size_t *idx, size_t count);
+
+// Inverts the specified bits. An index given more than once is inverted 
+// more than once. Nothing is changed if any index is out of range. 
+//
+// PARAMS: 
+// b     - the bitset to change
+// idx   - the indices of the bits
+// count - the number of indices
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_flip_many(bitset *b, const size_t *idx, size_t count);
+
+// Changes a range of bits to 1. 
+//
+// PARAMS: 
+// b   - the bitset to change
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_set_range(bitset *b, size_t pos, size_t n);
+
+// Changes a range of bits to 0. 
+//
+// PARAMS: 
+// b   - the bitset to change
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_clear_range(bitset *b, size_t pos, size_t n);
+
+// Inverts a range of bits. 
+//
+// PARAMS: 
+// b   - the bitset to change
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_flip_range(bitset *b, size_t pos, size_t n);
+
+// Returns the number of bits set to 1 in a range. 
+//
+// PARAMS: 
+// b   - the bitset to check
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// The number of bits set to 1, or 0 on error. 
+size_t bitset_count_range(const bitset *b, size_t pos, size_t n);
+
+// Determines whether any bit in a range is set to 1. 
+//
+// PARAMS: 
+// b   - the bitset to test
+// pos - the first bit of the range
+// n   - the number of bits in the range
+//
+// RET: 
+// True or false depending on whether any bit is set to 1. False on error. 
+_Bool bitset_any_range(const bitset *b, size_t pos, size_t n);
+
+// Returns the index of the first bit set to 1 at or after a position. 
+//
+// PARAMS: 
+// b    - the bitset to search
+// from - the position to start searching at
+//
+// RET: 
+// The index of the bit, or BITSET_NPOS if there is none. 
+size_t bitset_next_set(const bitset *b, size_t from);
+
+// Returns the index of the first bit set to 0 at or after a position. 
+//
+// PARAMS: 
+// b    - the bitset to search
+// from - the position to start searching at
+//
+// RET: 
+// The index of the bit, or BITSET_NPOS if there is none. 
+size_t bitset_next_clear(const bitset *b, size_t from);
+
+// Returns the index of the last bit set to 1 at or before a position. 
+//
+// PARAMS: 
+// b    - the bitset to search
+// from - the position to start searching at, going towards 0
+//
+// RET: 
+// The index of the bit, or BITSET_NPOS if there is none. 
+size_t bitset_prev_set(const bitset *b, size_t from);
+
+// Calls a function with the index of every bit set to 1, in increasing 
+// order, until the function returns false. 
+//
+// PARAMS: 
+// b   - the bitset to iterate
+// fn  - the function to call
+// ctx - the context passed to the function
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_foreach(const bitset *b, bitset_visit fn, void *ctx);
+
+// Writes the indices of every bit set to 1, in increasing order. The 
+// bitset must be at most 2^32 bits long. 
+//
+// PARAMS: 
+// b   - the bitset to decode
+// out - the output array, with room for bitset_true_len(b) indices
+//
+// RET: 
+// The number of indices written, 0 on error. 
+size_t bitset_to_indices(const bitset *b, uint32_t *out);
+
 // Returns the number of bits set to 1. 
 //
 // PARAMS: 
@@ -65,6 +586,33 @@ int bitset_init_str(bitset *b, const char *str, size_t n);
 // The number of bits that is set to 1. 
 size_t bitset_true_len(const bitset *b);
 
+// Starts caching the number of bits set to 1 in the specified bitset. 
+// Single bit changes then update the cached count directly, other changes 
+// mark the blocks they touch, and bitset_true_len only recounts the marked 
+// blocks. Does nothing if the count is already cached. 
+//
+// PARAMS: 
+// b - the bitset to cache the count of
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_cache_enable(bitset *b);
+
+// Stops caching the number of bits set to 1 in the specified bitset, 
+// freeing the cache. 
+//
+// PARAMS: 
+// b - the bitset to stop caching the count of
+void bitset_cache_disable(bitset *b);
+
+// Marks the cached count of the specified bitset as out of date, so that 
+// the next bitset_true_len recounts every block. Used after changing the 
+// bits directly. Does nothing if the count is not cached. 
+//
+// PARAMS: 
+// b - the bitset to invalidate
+void bitset_cache_invalidate(bitset *b);
+
 // Determines whether every bit in the bitset is set to 1. 
 //
 // PARAMS: 
@@ -83,6 +631,27 @@ _Bool bitset_all(const bitset *b);
 // True or false depending on whether any bit is set to 1. 
 _Bool bitset_any(const bitset *b);
 
+// Determines whether two bitsets have any bit set to 1 in common. 
+//
+// PARAMS: 
+// a - the first bitset
+// b - the second bitset
+//
+// RET: 
+// True or false depending on whether any bit is set to 1 in both bitsets. 
+_Bool bitset_intersects(const bitset *a, const bitset *b);
+
+// Determines whether every bit set to 1 in a bitset is also set to 1 in 
+// another. 
+//
+// PARAMS: 
+// a - the possible subset
+// b - the possible superset
+//
+// RET: 
+// True or false depending on whether a is a subset of b. 
+_Bool bitset_is_subset(const bitset *a, const bitset *b);
+
 // Performs AND operation, storing output in the left operand. 
 //
 // PARAMS: 
@@ -113,6 +682,164 @@ int bitset_or(bitset *lhs, const bitset *rhs);
 // Zero on success, non-zero on error. 
 int bitset_xor(bitset *lhs, const bitset *rhs);
 
+// Performs AND NOT operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand, used inverted
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_andnot(bitset *lhs, const bitset *rhs);
+
+// Performs AND operation, storing output in a separate bitset. The output may 
+// be one of the operands. 
+//
+// PARAMS: 
+// dst - the output bitset, initialised to the same length as the operands
+// a   - the left operand
+// b   - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_and3(bitset *dst, const bitset *a, const bitset *b);
+
+// Performs OR operation, storing output in a separate bitset. The output may 
+// be one of the operands. 
+//
+// PARAMS: 
+// dst - the output bitset, initialised to the same length as the operands
+// a   - the left operand
+// b   - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_or3(bitset *dst, const bitset *a, const bitset *b);
+
+// Performs XOR operation, storing output in a separate bitset. The output may 
+// be one of the operands. 
+//
+// PARAMS: 
+// dst - the output bitset, initialised to the same length as the operands
+// a   - the left operand
+// b   - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_xor3(bitset *dst, const bitset *a, const bitset *b);
+
+// Performs AND NOT operation (a & ~b), storing output in a separate bitset. 
+// The output may be one of the operands. 
+//
+// PARAMS: 
+// dst - the output bitset, initialised to the same length as the operands
+// a   - the left operand
+// b   - the right operand, used inverted
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_andnot3(bitset *dst, const bitset *a, const bitset *b);
+
+// Performs AND operation on any number of bitsets, storing output in a 
+// separate bitset. The operands are combined one cache-sized block at a 
+// time, and a block stops reading further operands once it is all 0. The 
+// output may be one of the operands. 
+//
+// PARAMS: 
+// dst  - the output bitset, initialised to the same length as the operands
+// srcs - the operands
+// k    - the number of operands, at least 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_and_many(bitset *dst, const bitset **srcs, size_t k);
+
+// Performs OR operation on any number of bitsets, storing output in a 
+// separate bitset. The operands are combined one cache-sized block at a 
+// time. The output may be one of the operands. 
+//
+// PARAMS: 
+// dst  - the output bitset, initialised to the same length as the operands
+// srcs - the operands
+// k    - the number of operands, at least 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_or_many(bitset *dst, const bitset **srcs, size_t k);
+
+// Performs XOR operation on any number of bitsets, storing output in a 
+// separate bitset. The operands are combined one cache-sized block at a 
+// time. The output may be one of the operands. 
+//
+// PARAMS: 
+// dst  - the output bitset, initialised to the same length as the operands
+// srcs - the operands
+// k    - the number of operands, at least 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_xor_many(bitset *dst, const bitset **srcs, size_t k);
+
+// Finds the bits set to 1 in at least t of any number of bitsets, storing 
+// output in a separate bitset. Each bit is counted with a bit-sliced 
+// counter, one word of counter per bit of the count. The output may be one 
+// of the operands. 
+//
+// PARAMS: 
+// dst  - the output bitset, initialised to the same length as the operands
+// srcs - the operands
+// k    - the number of operands, at least 1
+// t    - the number of operands a bit must be set to 1 in
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_threshold_many(bitset *dst, const bitset **srcs, size_t k,
+        size_t t);
+
+// Returns the number of bits set to 1 in the AND of two bitsets, without 
+// storing the result. 
+//
+// PARAMS: 
+// a - the left operand
+// b - the right operand
+//
+// RET: 
+// The number of bits set to 1, or 0 on error. 
+size_t bitset_and_count(const bitset *a, const bitset *b);
+
+// Returns the number of bits set to 1 in the OR of two bitsets, without 
+// storing the result. 
+//
+// PARAMS: 
+// a - the left operand
+// b - the right operand
+//
+// RET: 
+// The number of bits set to 1, or 0 on error. 
+size_t bitset_or_count(const bitset *a, const bitset *b);
+
+// Returns the number of bits set to 1 in the XOR of two bitsets, without 
+// storing the result. 
+//
+// PARAMS: 
+// a - the left operand
+// b - the right operand
+//
+// RET: 
+// The number of bits set to 1, or 0 on error. 
+size_t bitset_xor_count(const bitset *a, const bitset *b);
+
+// Returns the number of bits set to 1 in the AND NOT (a & ~b) of two 
+// bitsets, without storing the result. 
+//
+// PARAMS: 
+// a - the left operand
+// b - the right operand, used inverted
+//
+// RET: 
+// The number of bits set to 1, or 0 on error. 
+size_t bitset_andnot_count(const bitset *a, const bitset *b);
+
 // Performs NOT operation. 
 //
 // PARAMS: 
@@ -168,11 +895,16 @@ int bitset_rrot(bitset *b, size_t n);
 // b - the bitset to reset
 void bitset_reset(bitset *b);
 
-// Frees the internal storage of the given bitset. 
+// Frees the internal storage of the given bitset, returning it to the 
+// allocator it came from, along with any cached count. 
 //
 // PARAMS: 
 // b - the bitset to free
 void bitset_free(bitset *b);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
 
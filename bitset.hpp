@@ -0,0 +1,552 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset.hpp
+// Header-only C++14 bit sets, fixed at compile time or owning a C bitset. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_HPP
+#define BITSET_HPP
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include "bitset.h"
+
+namespace pm {
+
+// The fixed-size bitset type, laid out like the words of a C bitset. Every 
+// operation is constexpr and loops a constant number of times, so small 
+// bitsets are unrolled into a few register instructions. The unused bits 
+// of the last word are always kept at 0. It is not named bitset, so that 
+// using namespace pm does not make the C bitset type ambiguous. 
+template <std::size_t N>
+class fixed_bitset {
+    static_assert(N > 0, "bitset length must be positive");
+
+public:
+    static constexpr std::size_t words = BITSET_WORDS(N);
+
+    // Constructs a bitset with every bit set to 0. 
+    constexpr fixed_bitset() noexcept : w_{} {}
+
+    // Constructs a bitset from the bits of a word, lowest bit first. 
+    //
+    // PARAMS: 
+    // v - the word to construct from
+    constexpr explicit fixed_bitset(std::uint64_t v) noexcept : w_{} {
+        w_[0] = v;
+        trim();
+    }
+
+    // Returns the length of the bitset. 
+    constexpr std::size_t size() const noexcept { return N; }
+
+    // Determines whether the specified bit is set to 1. Does not check the 
+    // index. 
+    //
+    // PARAMS: 
+    // i - the index of the bit, less than N
+    //
+    // RET: 
+    // True or false depending on whether the bit is set to 1. 
+    constexpr bool test(std::size_t i) const noexcept {
+        return (w_[i / BITSET_WORD_LEN] >> (i % BITSET_WORD_LEN)) & 1;
+    }
+
+    // Changes the specified bit to 1. Does not check the index. 
+    //
+    // PARAMS: 
+    // i - the index of the bit, less than N
+    constexpr fixed_bitset &set(std::size_t i) noexcept {
+        w_[i / BITSET_WORD_LEN] |= mask(i);
+        return *this;
+    }
+
+    // Changes the specified bit to 0. Does not check the index. 
+    //
+    // PARAMS: 
+    // i - the index of the bit, less than N
+    constexpr fixed_bitset &clear(std::size_t i) noexcept {
+        w_[i / BITSET_WORD_LEN] &= ~mask(i);
+        return *this;
+    }
+
+    // Inverts the specified bit. Does not check the index. 
+    //
+    // PARAMS: 
+    // i - the index of the bit, less than N
+    constexpr fixed_bitset &flip(std::size_t i) noexcept {
+        w_[i / BITSET_WORD_LEN] ^= mask(i);
+        return *this;
+    }
+
+    // Changes every bit to 1. 
+    constexpr fixed_bitset &set() noexcept {
+        for (std::size_t k = 0; k < words; k++)
+            w_[k] = UINT64_MAX;
+        trim();
+        return *this;
+    }
+
+    // Changes every bit to 0. 
+    constexpr fixed_bitset &reset() noexcept {
+        for (std::size_t k = 0; k < words; k++)
+            w_[k] = 0;
+        return *this;
+    }
+
+    // Inverts every bit. 
+    constexpr fixed_bitset &flip() noexcept {
+        for (std::size_t k = 0; k < words; k++)
+            w_[k] = ~w_[k];
+        trim();
+        return *this;
+    }
+
+    // Returns the number of bits set to 1. 
+    constexpr std::size_t count() const noexcept {
+        std::size_t c = 0;
+        for (std::size_t k = 0; k < words; k++)
+            c += popcount(w_[k]);
+        return c;
+    }
+
+    // Determines whether any bit is set to 1. 
+    constexpr bool any() const noexcept {
+        std::uint64_t v = 0;
+        for (std::size_t k = 0; k < words; k++)
+            v |= w_[k];
+        return v != 0;
+    }
+
+    // Determines whether every bit is set to 0. 
+    constexpr bool none() const noexcept { return !any(); }
+
+    // Determines whether every bit is set to 1. 
+    constexpr bool all() const noexcept {
+        return *this == fixed_bitset().set();
+    }
+
+    // Returns the index of the first bit set to 1, starting from a bit. 
+    //
+    // PARAMS: 
+    // from - the index to start from
+    //
+    // RET: 
+    // The index of the bit, or BITSET_NPOS if there is none. 
+    constexpr std::size_t next_set(std::size_t from) const noexcept {
+        if (from >= N)
+            return BITSET_NPOS;
+        std::size_t k = from / BITSET_WORD_LEN;
+        std::uint64_t v = w_[k] & (UINT64_MAX << (from % BITSET_WORD_LEN));
+        while (v == 0) {
+            if (++k == words)
+                return BITSET_NPOS;
+            v = w_[k];
+        }
+        return k * BITSET_WORD_LEN + ctz(v);
+    }
+
+    constexpr fixed_bitset &operator&=(const fixed_bitset &o) noexcept {
+        for (std::size_t k = 0; k < words; k++)
+            w_[k] &= o.w_[k];
+        return *this;
+    }
+
+    constexpr fixed_bitset &operator|=(const fixed_bitset &o) noexcept {
+        for (std::size_t k = 0; k < words; k++)
+            w_[k] |= o.w_[k];
+        return *this;
+    }
+
+    constexpr fixed_bitset &operator^=(const fixed_bitset &o) noexcept {
+        for (std::size_t k = 0; k < words; k++)
+            w_[k] ^= o.w_[k];
+        return *this;
+    }
+
+    // Performs AND NOT operation (*this & ~o). 
+    //
+    // PARAMS: 
+    // o - the right operand, used inverted
+    constexpr fixed_bitset &andnot(const fixed_bitset &o) noexcept {
+        for (std::size_t k = 0; k < words; k++)
+            w_[k] &= ~o.w_[k];
+        return *this;
+    }
+
+    // Performs left shift as bitset_lsh does, so that bit i takes bit 
+    // i + n. 
+    //
+    // PARAMS: 
+    // n - the number of shifts
+    constexpr fixed_bitset &lsh(std::size_t n) noexcept {
+        std::size_t q = n / BITSET_WORD_LEN, s = n % BITSET_WORD_LEN;
+        for (std::size_t k = 0; k < words; k++) {
+            std::uint64_t lo = (k + q < words) ? w_[k + q] : 0;
+            std::uint64_t hi = (k + q + 1 < words) ? w_[k + q + 1] : 0;
+            w_[k] = (s == 0) ? lo : (lo >> s) | (hi << (BITSET_WORD_LEN - s));
+        }
+        return *this;
+    }
+
+    // Performs right shift as bitset_rsh does, so that bit i takes bit 
+    // i - n. 
+    //
+    // PARAMS: 
+    // n - the number of shifts
+    constexpr fixed_bitset &rsh(std::size_t n) noexcept {
+        std::size_t q = n / BITSET_WORD_LEN, s = n % BITSET_WORD_LEN;
+        for (std::size_t k = words; k-- > 0; ) {
+            std::uint64_t hi = (k >= q) ? w_[k - q] : 0;
+            std::uint64_t lo = (k >= q + 1) ? w_[k - q - 1] : 0;
+            w_[k] = (s == 0) ? hi : (hi << s) | (lo >> (BITSET_WORD_LEN - s));
+        }
+        trim();
+        return *this;
+    }
+
+    friend constexpr fixed_bitset operator&(fixed_bitset a,
+            const fixed_bitset &b) noexcept {
+        return a &= b;
+    }
+
+    friend constexpr fixed_bitset operator|(fixed_bitset a,
+            const fixed_bitset &b) noexcept {
+        return a |= b;
+    }
+
+    friend constexpr fixed_bitset operator^(fixed_bitset a,
+            const fixed_bitset &b) noexcept {
+        return a ^= b;
+    }
+
+    friend constexpr fixed_bitset operator~(fixed_bitset a) noexcept {
+        return a.flip();
+    }
+
+    friend constexpr bool operator==(const fixed_bitset &a,
+            const fixed_bitset &b) noexcept {
+        std::uint64_t v = 0;
+        for (std::size_t k = 0; k < words; k++)
+            v |= a.w_[k] ^ b.w_[k];
+        return v == 0;
+    }
+
+    friend constexpr bool operator!=(const fixed_bitset &a,
+            const fixed_bitset &b) noexcept {
+        return !(a == b);
+    }
+
+    // Returns the words of the bitset. 
+    constexpr const std::uint64_t *data() const noexcept { return w_; }
+
+    // Copies the bits of a C bitset of N bits into this bitset. 
+    //
+    // PARAMS: 
+    // b - the bitset to copy from
+    //
+    // RET: 
+    // Zero on success, non-zero on error. 
+    int load(const ::bitset *b) noexcept {
+        if (b == nullptr || b->bits == nullptr)
+            return BITSET_NULL_ERR;
+        if (b->len != N)
+            return BITSET_LENGTH_ERR;
+        std::memcpy(w_, b->bits, sizeof w_);
+        return BITSET_GOOD;
+    }
+
+    // Copies this bitset into an initialised C bitset of N bits. 
+    //
+    // PARAMS: 
+    // b - the bitset to copy into
+    //
+    // RET: 
+    // Zero on success, non-zero on error. 
+    int store(::bitset *b) const noexcept {
+        if (b == nullptr || b->bits == nullptr)
+            return BITSET_NULL_ERR;
+        if (b->len != N)
+            return BITSET_LENGTH_ERR;
+        std::memcpy(b->bits, w_, sizeof w_);
+        bitset_cache_invalidate(b);
+        return BITSET_GOOD;
+    }
+
+private:
+    // Returns the mask of a bit within its word. 
+    static constexpr std::uint64_t mask(std::size_t i) noexcept {
+        return std::uint64_t(1) << (i % BITSET_WORD_LEN);
+    }
+
+    // Returns the number of bits set to 1 in a word. 
+    static constexpr std::size_t popcount(std::uint64_t w) noexcept {
+#if defined(__GNUC__)
+        return static_cast<std::size_t>(__builtin_popcountll(w));
+#else
+        w = w - ((w >> 1) & 0x5555555555555555ULL);
+        w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+        w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<std::size_t>((w * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    // Returns the index of the lowest bit set to 1 in a word, not 0. 
+    static constexpr std::size_t ctz(std::uint64_t w) noexcept {
+#if defined(__GNUC__)
+        return static_cast<std::size_t>(__builtin_ctzll(w));
+#else
+        std::size_t n = 0;
+        while (!(w & 1)) {
+            w >>= 1;
+            n++;
+        }
+        return n;
+#endif
+    }
+
+    // Keeps the unused bits of the last word at 0. 
+    constexpr void trim() noexcept {
+        if (N % BITSET_WORD_LEN != 0)
+            w_[words - 1] &= UINT64_MAX >> (BITSET_WORD_LEN
+                    - N % BITSET_WORD_LEN);
+    }
+
+    std::uint64_t w_[words];    // internal bits, packed into words
+};
+
+template <std::size_t N>
+constexpr std::size_t fixed_bitset<N>::words;
+
+// The owning bitset type, wrapping a C bitset freed on destruction. Moving 
+// steals the bits without copying them, so bitsets can be returned by value 
+// cheaply. Errors from the C functions are thrown as exceptions. 
+class dynamic_bitset {
+public:
+    // Constructs an empty bitset, holding no bits. 
+    dynamic_bitset() noexcept : b_() {}
+
+    // Constructs a bitset with every bit set to 0. Throws length_error if 
+    // the length is 0, use the default constructor for an empty bitset. 
+    //
+    // PARAMS: 
+    // n     - the length of the bitset
+    // alloc - the allocator to use, or nullptr for malloc
+    explicit dynamic_bitset(std::size_t n,
+            const bitset_allocator *alloc = nullptr) : b_() {
+        if (n == 0)
+            throw std::length_error("bitset length is 0");
+        check(bitset_init_alloc(&b_, n, alloc));
+    }
+
+    // Constructs a bitset from a bit string of '0' and '1' characters. This 
+    // is not a constructor, since dynamic_bitset(0) would then be ambiguous. 
+    // Throws length_error if the string is empty. 
+    //
+    // PARAMS: 
+    // str - the bit string, NUL terminated
+    //
+    // RET: 
+    // The bitset of the string. 
+    static dynamic_bitset from_bstr(const char *str) {
+        std::size_t n = std::strlen(str);
+        if (n == 0)
+            throw std::length_error("bitset length is 0");
+        dynamic_bitset d;
+        check(bitset_init_bstr(&d.b_, str, n));
+        return d;
+    }
+
+    // Constructs a copy of a bitset. A copy of an empty bitset is empty. 
+    dynamic_bitset(const dynamic_bitset &o) : b_() {
+        if (o.b_.bits != nullptr)
+            check(bitset_copy(&b_, &o.b_));
+    }
+
+    dynamic_bitset(dynamic_bitset &&o) noexcept : b_() {
+        bitset_move(&b_, &o.b_);
+    }
+
+    dynamic_bitset &operator=(const dynamic_bitset &o) {
+        dynamic_bitset t(o);
+        swap(t);
+        return *this;
+    }
+
+    dynamic_bitset &operator=(dynamic_bitset &&o) noexcept {
+        if (this != &o) {
+            bitset_free(&b_);
+            bitset_move(&b_, &o.b_);
+        }
+        return *this;
+    }
+
+    ~dynamic_bitset() { bitset_free(&b_); }
+
+    // Swaps the bits of two bitsets without copying them. 
+    //
+    // PARAMS: 
+    // o - the bitset to swap with
+    void swap(dynamic_bitset &o) noexcept { bitset_swap(&b_, &o.b_); }
+
+    friend void swap(dynamic_bitset &a, dynamic_bitset &b) noexcept {
+        a.swap(b);
+    }
+
+    // Returns the wrapped C bitset, for the functions not wrapped here. 
+    ::bitset *get() noexcept { return &b_; }
+    const ::bitset *get() const noexcept { return &b_; }
+
+    // Returns the length of the bitset, 0 if it holds no bits. 
+    std::size_t size() const noexcept {
+        return (b_.bits != nullptr) ? b_.len : 0;
+    }
+
+    // Returns the number of bits set to 1. 
+    std::size_t count() const noexcept { return bitset_true_len(&b_); }
+
+    bool any() const noexcept { return bitset_any(&b_); }
+    bool all() const noexcept { return bitset_all(&b_); }
+
+    // Determines whether the specified bit is set to 1. 
+    //
+    // PARAMS: 
+    // i - the index of the bit
+    //
+    // RET: 
+    // True or false depending on whether the bit is set to 1. False if 
+    // the index is out of range. 
+    bool test(std::size_t i) const noexcept {
+        return bitset_test_checked(&b_, i);
+    }
+
+    dynamic_bitset &set(std::size_t i) {
+        check(bitset_set_checked(&b_, i));
+        return *this;
+    }
+
+    dynamic_bitset &clear(std::size_t i) {
+        check(bitset_clear_checked(&b_, i));
+        return *this;
+    }
+
+    dynamic_bitset &flip(std::size_t i) {
+        check(bitset_flip_checked(&b_, i));
+        return *this;
+    }
+
+    // Changes the length of the bitset. New bits are set to 0. 
+    //
+    // PARAMS: 
+    // n - the new length of the bitset
+    void resize(std::size_t n) { check(bitset_resize(&b_, n)); }
+
+    // Appends a bit to the end of the bitset. 
+    //
+    // PARAMS: 
+    // v - the value of the new bit
+    void push_back(bool v) { check(bitset_push_back(&b_, v)); }
+
+    dynamic_bitset &operator&=(const dynamic_bitset &o) {
+        check(bitset_and(&b_, &o.b_));
+        return *this;
+    }
+
+    dynamic_bitset &operator|=(const dynamic_bitset &o) {
+        check(bitset_or(&b_, &o.b_));
+        return *this;
+    }
+
+    dynamic_bitset &operator^=(const dynamic_bitset &o) {
+        check(bitset_xor(&b_, &o.b_));
+        return *this;
+    }
+
+    // Performs left shift as bitset_lsh does, so that bit i takes bit 
+    // i + n. 
+    dynamic_bitset &operator<<=(std::size_t n) {
+        check(bitset_lsh(&b_, n));
+        return *this;
+    }
+
+    // Performs right shift as bitset_rsh does, so that bit i takes bit 
+    // i - n. 
+    dynamic_bitset &operator>>=(std::size_t n) {
+        check(bitset_rsh(&b_, n));
+        return *this;
+    }
+
+    // The binary operators take the left operand by value, so a temporary 
+    // is reused for the result instead of copied. 
+    friend dynamic_bitset operator&(dynamic_bitset a, const dynamic_bitset &b) {
+        a &= b;
+        return a;
+    }
+
+    friend dynamic_bitset operator|(dynamic_bitset a, const dynamic_bitset &b) {
+        a |= b;
+        return a;
+    }
+
+    friend dynamic_bitset operator^(dynamic_bitset a, const dynamic_bitset &b) {
+        a ^= b;
+        return a;
+    }
+
+    friend dynamic_bitset operator~(dynamic_bitset a) {
+        check(bitset_not(&a.b_));
+        return a;
+    }
+
+    friend dynamic_bitset operator<<(dynamic_bitset a, std::size_t n) {
+        a <<= n;
+        return a;
+    }
+
+    friend dynamic_bitset operator>>(dynamic_bitset a, std::size_t n) {
+        a >>= n;
+        return a;
+    }
+
+    friend bool operator==(const dynamic_bitset &a, const dynamic_bitset &b)
+            noexcept {
+        return a.size() == b.size() && (a.size() == 0
+                || std::memcmp(a.b_.bits, b.b_.bits,
+                    BITSET_WORDS(a.b_.len) * sizeof(std::uint64_t)) == 0);
+    }
+
+    friend bool operator!=(const dynamic_bitset &a, const dynamic_bitset &b)
+            noexcept {
+        return !(a == b);
+    }
+
+private:
+    // Throws the exception matching an error code of the C functions. 
+    //
+    // PARAMS: 
+    // ret - the error code
+    static void check(int ret) {
+        switch (ret) {
+        case BITSET_GOOD:
+            return;
+        case BITSET_ALLOC_ERR:
+            throw std::bad_alloc();
+        case BITSET_LENGTH_ERR:
+            throw std::length_error("bitset length error");
+        case BITSET_RANGE_ERR:
+            throw std::out_of_range("bitset index out of range");
+        default:
+            throw std::invalid_argument("bitset holds no bits");
+        }
+    }
+
+    ::bitset b_;    // the wrapped bitset
+};
+
+}
+
+#endif
@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_alloc.c
+// Arena and free list allocators for the bits of short-lived bitsets. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bitset_alloc.h"
+#define ALIGN 64
+#define ARENA_BLOCK 65536
+#define ROUND_UP(n, a) (((n) + (a) - 1) / (a) * (a))
+
+// The arena block type, followed by its memory. 
+typedef struct bitset_block_t {
+    struct bitset_block_t *next;    // next block
+    size_t size;                    // usable bytes of the block
+} block;
+
+static void *arena_alloc(size_t size, void *ctx);
+static void arena_release(void *p, size_t size, void *ctx);
+static void *freelist_alloc(size_t size, void *ctx);
+static void freelist_release(void *p, size_t size, void *ctx);
+static size_t size_class(size_t size);
+static void *block_mem(block *blk, size_t off);
+
+// Initialises the specified arena. 
+//
+// PARAMS: 
+// a          - the arena to initialise
+// block_size - the size of each block in bytes, or 0 for 64 KiB
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_arena_init(bitset_arena *a, size_t block_size) {
+    if (a == NULL)
+        return BITSET_NULL_ERR;
+
+    a->base.alloc = arena_alloc;
+    a->base.release = arena_release;
+    a->base.ctx = a;
+    a->head = NULL;
+    a->cur = NULL;
+    a->used = 0;
+    a->block_size = ROUND_UP((block_size == 0) ? ARENA_BLOCK : block_size,
+            ALIGN);
+    return BITSET_GOOD;
+}
+
+// Releases every allocation of an arena at once, keeping its blocks. 
+// Bitsets allocated from the arena must not be used afterwards. 
+//
+// PARAMS: 
+// a - the arena to reset
+void bitset_arena_reset(bitset_arena *a) {
+    if (a != NULL) {
+        a->cur = a->head;
+        a->used = 0;
+    }
+}
+
+// Frees the blocks of the given arena. 
+//
+// PARAMS: 
+// a - the arena to free
+void bitset_arena_free(bitset_arena *a) {
+    if (a != NULL) {
+        for (block *b = a->head, *next; b != NULL; b = next) {
+            next = b->next;
+            free(b);
+        }
+        a->head = NULL;
+        a->cur = NULL;
+        a->used = 0;
+    }
+}
+
+// Initialises the specified free list. 
+//
+// PARAMS: 
+// f - the free list to initialise
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_freelist_init(bitset_freelist *f) {
+    if (f == NULL)
+        return BITSET_NULL_ERR;
+
+    f->base.alloc = freelist_alloc;
+    f->base.release = freelist_release;
+    f->base.ctx = f;
+    for (size_t i = 0; i < BITSET_FREELIST_CLASSES; i++)
+        f->lists[i] = NULL;
+    return BITSET_GOOD;
+}
+
+// Frees the blocks kept by the given free list. 
+//
+// PARAMS: 
+// f - the free list to free
+void bitset_freelist_free(bitset_freelist *f) {
+    if (f != NULL) {
+        for (size_t i = 0; i < BITSET_FREELIST_CLASSES; i++) {
+            while (f->lists[i] != NULL) {
+                void *next = *(void **)f->lists[i];
+                free(f->lists[i]);
+                f->lists[i] = next;
+            }
+        }
+    }
+}
+
+// Allocates memory from an arena, moving on to the next block, or adding 
+// one, when the current block is full. 
+//
+// PARAMS: 
+// size - the number of bytes to allocate
+// ctx  - the arena
+//
+// RET: 
+// The allocated memory, aligned to 64 bytes, or NULL on error. 
+static void *arena_alloc(size_t size, void *ctx) {
+    bitset_arena *a = ctx;
+    size = ROUND_UP(size, ALIGN);
+    if (a->cur != NULL && a->cur->size - a->used >= size) {
+        a->used += size;
+        return block_mem(a->cur, a->used - size);
+    }
+
+    // reuse a later block kept by a reset, if one is big enough
+    block *prev = a->cur;
+    block *b = (prev == NULL) ? a->head : prev->next;
+    while (b != NULL && b->size < size) {
+        prev = b;
+        b = b->next;
+    }
+    if (b == NULL) {
+        size_t n = (size > a->block_size) ? size : a->block_size;
+        if (n > SIZE_MAX - sizeof(block) - ALIGN)
+            return NULL;
+        b = malloc(sizeof(block) + n + ALIGN);
+        if (b == NULL)
+            return NULL;
+        b->size = n;
+        b->next = NULL;
+        if (prev == NULL)
+            a->head = b;
+        else
+            prev->next = b;
+    }
+    a->cur = b;
+    a->used = size;
+    return block_mem(b, 0);
+}
+
+// Releases memory of an arena, which is only reclaimed by a reset. 
+//
+// PARAMS: 
+// p    - the memory to release
+// size - the number of bytes allocated
+// ctx  - the arena
+static void arena_release(void *p, size_t size, void *ctx) {
+    (void)p;
+    (void)size;
+    (void)ctx;
+}
+
+// Allocates memory from a free list, reusing a released block of the same 
+// size class if there is one. 
+//
+// PARAMS: 
+// size - the number of bytes to allocate
+// ctx  - the free list
+//
+// RET: 
+// The allocated memory, or NULL on error. 
+static void *freelist_alloc(size_t size, void *ctx) {
+    bitset_freelist *f = ctx;
+    size_t c = size_class(size);
+    if (c >= BITSET_FREELIST_CLASSES)
+        return malloc(size);
+
+    void *p = f->lists[c];
+    if (p != NULL) {
+        f->lists[c] = *(void **)p;
+        return p;
+    }
+    return malloc(sizeof(uint64_t) << c);
+}
+
+// Releases memory to a free list, keeping it for the next allocation of 
+// the same size class. 
+//
+// PARAMS: 
+// p    - the memory to release
+// size - the number of bytes allocated
+// ctx  - the free list
+static void freelist_release(void *p, size_t size, void *ctx) {
+    bitset_freelist *f = ctx;
+    size_t c = size_class(size);
+    if (c >= BITSET_FREELIST_CLASSES) {
+        free(p);
+    } else {
+        *(void **)p = f->lists[c];
+        f->lists[c] = p;
+    }
+}
+
+// Returns the size class of an allocation, the smallest c where 2^c words 
+// hold it. 
+//
+// PARAMS: 
+// size - the number of bytes to allocate
+//
+// RET: 
+// The size class of the allocation. 
+static size_t size_class(size_t size) {
+    size_t words = (size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    if (words <= 1)
+        return 0;
+    return BITSET_WORD_LEN - bitset_clz64((uint64_t)(words - 1));
+}
+
+// Returns the memory of an arena block at an offset. The memory starts at 
+// the first 64-byte boundary after the header. 
+//
+// PARAMS: 
+// blk - the block
+// off - the offset in bytes
+//
+// RET: 
+// The memory at the offset. 
+static void *block_mem(block *blk, size_t off) {
+    char *p = (char *)(blk + 1);
+    return p + (ALIGN - (uintptr_t)p % ALIGN) % ALIGN + off;
+}
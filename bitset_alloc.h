@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_alloc.h
+// Arena and free list allocators for the bits of short-lived bitsets. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_ALLOC_H
+#define BITSET_ALLOC_H
+#include "bitset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of size classes of a free list, the largest holding 2^15 words. 
+#define BITSET_FREELIST_CLASSES 16
+
+// The arena type. Allocations are carved out of large blocks and are only 
+// released together by bitset_arena_reset, which keeps the blocks for 
+// reuse. An arena is not thread safe, so use one per thread. Pass &base to 
+// bitset_init_alloc, and do not move the arena once initialised. 
+typedef struct bitset_arena_t {
+    bitset_allocator base;          // the allocator of the arena
+    struct bitset_block_t *head;    // first block
+    struct bitset_block_t *cur;     // block being carved
+    size_t used;                    // bytes used in the current block
+    size_t block_size;              // bytes per block
+} bitset_arena;
+
+// The free list type. Released bits are kept in lists by power of two size 
+// class and handed out again to bitsets of the same class. A free list is 
+// not thread safe, so use one per thread. Pass &base to bitset_init_alloc, 
+// and do not move the free list once initialised. 
+typedef struct bitset_freelist_t {
+    bitset_allocator base;                      // the allocator of the list
+    void *lists[BITSET_FREELIST_CLASSES];       // released blocks by class
+} bitset_freelist;
+
+// Initialises the specified arena. 
+//
+// PARAMS: 
+// a          - the arena to initialise
+// block_size - the size of each block in bytes, or 0 for 64 KiB
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_arena_init(bitset_arena *a, size_t block_size);
+
+// Releases every allocation of an arena at once, keeping its blocks. 
+// Bitsets allocated from the arena must not be used afterwards. 
+//
+// PARAMS: 
+// a - the arena to reset
+void bitset_arena_reset(bitset_arena *a);
+
+// Frees the blocks of the given arena. 
+//
+// PARAMS: 
+// a - the arena to free
+void bitset_arena_free(bitset_arena *a);
+
+// Initialises the specified free list. 
+//
+// PARAMS: 
+// f - the free list to initialise
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_freelist_init(bitset_freelist *f);
+
+// Frees the blocks kept by the given free list. 
+//
+// PARAMS: 
+// f - the free list to free
+void bitset_freelist_free(bitset_freelist *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,228 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_atomic.c
+// Bit set safe for concurrent readers and writers without locks. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bitset_atomic.h"
+#define WORD_LEN BITSET_WORD_LEN
+#define BIT_MASK(i) ((uint64_t)1 << ((i) % WORD_LEN))
+
+#ifdef __GNUC__
+#define LOAD_RELAXED(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define FETCH_OR(p, v) __atomic_fetch_or((p), (v), __ATOMIC_ACQ_REL)
+#define FETCH_AND(p, v) __atomic_fetch_and((p), (v), __ATOMIC_ACQ_REL)
+#else
+#error "bitset_atomic.c needs the GCC/Clang __atomic builtins"
+#endif
+
+static uint64_t valid_mask(size_t len, size_t word);
+
+// Initialises the specified atomic bitset, with every bit set to 0. 
+//
+// PARAMS: 
+// a - the atomic bitset to initialise
+// n - the length of the atomic bitset
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_atomic_init(bitset_atomic *a, size_t n) {
+    if (a == NULL || n == 0)
+        return BITSET_NULL_ERR;
+
+    a->len = n;
+    a->bits = calloc(BITSET_WORDS(n), sizeof(uint64_t));
+    return (a->bits == NULL) ? BITSET_ALLOC_ERR : BITSET_GOOD;
+}
+
+// Changes the specified bit to 1. 
+//
+// PARAMS: 
+// a - the atomic bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_atomic_set(bitset_atomic *a, size_t i) {
+    if (a == NULL || a->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (i >= a->len)
+        return BITSET_RANGE_ERR;
+
+    FETCH_OR(&a->bits[i / WORD_LEN], BIT_MASK(i));
+    return BITSET_GOOD;
+}
+
+// Changes the specified bit to 0. 
+//
+// PARAMS: 
+// a - the atomic bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_atomic_clear(bitset_atomic *a, size_t i) {
+    if (a == NULL || a->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (i >= a->len)
+        return BITSET_RANGE_ERR;
+
+    FETCH_AND(&a->bits[i / WORD_LEN], ~BIT_MASK(i));
+    return BITSET_GOOD;
+}
+
+// Determines whether the specified bit is set to 1. 
+//
+// PARAMS: 
+// a - the atomic bitset to test
+// i - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit is set to 1. False on error. 
+_Bool bitset_atomic_test(const bitset_atomic *a, size_t i) {
+    if (a == NULL || a->bits == NULL || i >= a->len)
+        return false;
+
+    return (LOAD_ACQUIRE(&a->bits[i / WORD_LEN]) & BIT_MASK(i)) != 0;
+}
+
+// Changes the specified bit to 1, returning its previous value. Exactly one 
+// of several threads setting the same bit sees false. 
+//
+// PARAMS: 
+// a - the atomic bitset to change
+// i - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit was set to 1. True on error, 
+// so an invalid bit is never claimed. 
+_Bool bitset_atomic_test_and_set(bitset_atomic *a, size_t i) {
+    if (a == NULL || a->bits == NULL || i >= a->len)
+        return true;
+
+    uint64_t *w = &a->bits[i / WORD_LEN];
+    if (LOAD_ACQUIRE(w) & BIT_MASK(i))
+        return true;            // already set, skip the locked write
+    return (FETCH_OR(w, BIT_MASK(i)) & BIT_MASK(i)) != 0;
+}
+
+// Changes the specified bit to 0, returning its previous value. 
+//
+// PARAMS: 
+// a - the atomic bitset to change
+// i - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit was set to 1. False on error. 
+_Bool bitset_atomic_test_and_clear(bitset_atomic *a, size_t i) {
+    if (a == NULL || a->bits == NULL || i >= a->len)
+        return false;
+
+    return (FETCH_AND(&a->bits[i / WORD_LEN], ~BIT_MASK(i))
+            & BIT_MASK(i)) != 0;
+}
+
+// Finds a bit set to 0 and changes it to 1, searching from the specified 
+// index and wrapping around. Threads starting from different indices 
+// rarely contend on the same word. 
+//
+// PARAMS: 
+// a    - the atomic bitset to change
+// from - the index to start searching from
+//
+// RET: 
+// The index of the claimed bit, or BITSET_NPOS if every bit is set to 1. 
+size_t bitset_atomic_claim(bitset_atomic *a, size_t from) {
+    if (a == NULL || a->bits == NULL)
+        return BITSET_NPOS;
+
+    from = (from < a->len) ? from : 0;
+    size_t nw = BITSET_WORDS(a->len), start = from / WORD_LEN;
+    uint64_t low = BIT_MASK(from) - 1;  // bits of the first word before from
+    for (size_t k = 0; k <= nw; k++) {
+        size_t i = (start + k) % nw;
+        uint64_t mask = valid_mask(a->len, i);
+        if (k == 0)
+            mask &= ~low;
+        else if (k == nw)
+            mask &= low;
+
+        uint64_t zeros = ~LOAD_RELAXED(&a->bits[i]) & mask;
+        while (zeros != 0) {
+            uint64_t bit = zeros & -zeros;
+            uint64_t old = FETCH_OR(&a->bits[i], bit);
+            if ((old & bit) == 0)
+                return i * WORD_LEN + bitset_ctz64(bit);
+            zeros = ~old & mask;
+        }
+    }
+    return BITSET_NPOS;
+}
+
+// Returns the number of bits set to 1. Words are read one at a time, so 
+// the count may mix changes made while counting. 
+//
+// PARAMS: 
+// a - the atomic bitset to check
+//
+// RET: 
+// The number of bits that is set to 1. 
+size_t bitset_atomic_true_len(const bitset_atomic *a) {
+    if (a == NULL || a->bits == NULL)
+        return 0;
+
+    size_t ret = 0, nw = BITSET_WORDS(a->len);
+    for (size_t i = 0; i < nw; i++)
+        ret += bitset_popcount64(LOAD_RELAXED(&a->bits[i]));
+    return ret;
+}
+
+// Copies an atomic bitset into a bitset of the same length, one word at a 
+// time. 
+//
+// PARAMS: 
+// a - the atomic bitset to copy
+// b - the bitset to copy into
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_atomic_snapshot(const bitset_atomic *a, bitset *b) {
+    if (a == NULL || b == NULL || a->bits == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (a->len != b->len)
+        return BITSET_LENGTH_ERR;
+
+    size_t nw = BITSET_WORDS(a->len);
+    for (size_t i = 0; i < nw; i++)
+        b->bits[i] = LOAD_ACQUIRE(&a->bits[i]);
+    bitset_cache_invalidate(b);
+    return BITSET_GOOD;
+}
+
+// Frees the internal storage of the given atomic bitset. 
+//
+// PARAMS: 
+// a - the atomic bitset to free
+void bitset_atomic_free(bitset_atomic *a) {
+    if (a != NULL) {
+        free(a->bits);
+        a->bits = NULL;
+    }
+}
+
+// Returns the mask of the bits of a word that lie inside the bitset. 
+//
+// PARAMS: 
+// len  - the length of the bitset
+// word - the index of the word
+//
+// RET: 
+// The mask of the used bits of the word. 
+static uint64_t valid_mask(size_t len, size_t word) {
+    if (word + 1 < BITSET_WORDS(len) || len % WORD_LEN == 0)
+        return UINT64_MAX;
+    return UINT64_MAX >> (WORD_LEN - len % WORD_LEN);
+}
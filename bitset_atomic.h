@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_atomic.h
+// Bit set safe for concurrent readers and writers without locks. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_ATOMIC_H
+#define BITSET_ATOMIC_H
+#include "bitset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The atomic bitset type. Every word is only accessed with atomic 
+// operations, so any number of threads may change and test bits at once. 
+// Changes to a bit are release operations and tests are acquire operations. 
+typedef struct bitset_atomic_t {
+    uint64_t *bits; // internal bits, packed into words
+    size_t len;     // length in bits
+} bitset_atomic;
+
+// Initialises the specified atomic bitset, with every bit set to 0. 
+//
+// PARAMS: 
+// a - the atomic bitset to initialise
+// n - the length of the atomic bitset
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_atomic_init(bitset_atomic *a, size_t n);
+
+// Changes the specified bit to 1. 
+//
+// PARAMS: 
+// a - the atomic bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_atomic_set(bitset_atomic *a, size_t i);
+
+// Changes the specified bit to 0. 
+//
+// PARAMS: 
+// a - the atomic bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_atomic_clear(bitset_atomic *a, size_t i);
+
+// Determines whether the specified bit is set to 1. 
+//
+// PARAMS: 
+// a - the atomic bitset to test
+// i - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit is set to 1. False on error. 
+_Bool bitset_atomic_test(const bitset_atomic *a, size_t i);
+
+// Changes the specified bit to 1, returning its previous value. Exactly one 
+// of several threads setting the same bit sees false. 
+//
+// PARAMS: 
+// a - the atomic bitset to change
+// i - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit was set to 1. True on error, 
+// so an invalid bit is never claimed. 
+_Bool bitset_atomic_test_and_set(bitset_atomic *a, size_t i);
+
+// Changes the specified bit to 0, returning its previous value. 
+//
+// PARAMS: 
+// a - the atomic bitset to change
+// i - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit was set to 1. False on error. 
+_Bool bitset_atomic_test_and_clear(bitset_atomic *a, size_t i);
+
+// Finds a bit set to 0 and changes it to 1, searching from the specified 
+// index and wrapping around. Threads starting from different indices 
+// rarely contend on the same word. 
+//
+// PARAMS: 
+// a    - the atomic bitset to change
+// from - the index to start searching from
+//
+// RET: 
+// The index of the claimed bit, or BITSET_NPOS if every bit is set to 1. 
+size_t bitset_atomic_claim(bitset_atomic *a, size_t from);
+
+// Returns the number of bits set to 1. Words are read one at a time, so 
+// the count may mix changes made while counting. 
+//
+// PARAMS: 
+// a - the atomic bitset to check
+//
+// RET: 
+// The number of bits that is set to 1. 
+size_t bitset_atomic_true_len(const bitset_atomic *a);
+
+// Copies an atomic bitset into a bitset of the same length, one word at a 
+// time. 
+//
+// PARAMS: 
+// a - the atomic bitset to copy
+// b - the bitset to copy into
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_atomic_snapshot(const bitset_atomic *a, bitset *b);
+
+// Frees the internal storage of the given atomic bitset. 
+//
+// PARAMS: 
+// a - the atomic bitset to free
+void bitset_atomic_free(bitset_atomic *a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
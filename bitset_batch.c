@@ -0,0 +1,481 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_batch.c
+// Many bitsets of the same length, stored in one block of memory. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bitset_batch.h"
+#include "bitset_kernel.h"
+#define ALIGN 64
+#define ALIGN_WORDS (ALIGN / sizeof(uint64_t))
+#define ROUND_UP(n, a) (((n) + (a) - 1) / (a) * (a))
+
+static int check_shape(const bitset_batch *dst, const bitset_batch *a,
+        const bitset_batch *b);
+static int check_mask(const bitset_batch *bb, const bitset *mask);
+static size_t total_words(const bitset_batch *bb);
+static void columns_and(uint64_t *restrict w, const bitset_batch *bb,
+        const uint64_t *restrict mask);
+static void columns_or(uint64_t *restrict w, const bitset_batch *bb,
+        const uint64_t *restrict mask);
+static void columns_count(const uint64_t *restrict w, const bitset_batch *bb,
+        const uint64_t *restrict mask, size_t *restrict counts);
+
+// Initialises the specified batch, with every bit set to 0. 
+//
+// PARAMS: 
+// bb     - the batch to initialise
+// count  - the number of bitsets
+// len    - the length of each bitset
+// layout - BITSET_BATCH_ROWS or BITSET_BATCH_COLUMNS
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_init(bitset_batch *bb, size_t count, size_t len,
+        int layout) {
+    if (bb == NULL || count == 0 || len == 0)
+        return BITSET_NULL_ERR;
+    if (layout != BITSET_BATCH_ROWS && layout != BITSET_BATCH_COLUMNS)
+        return BITSET_RANGE_ERR;
+    if (len > SIZE_MAX - BITSET_WORD_LEN * ALIGN_WORDS
+            || count > SIZE_MAX - ALIGN_WORDS)
+        return BITSET_LENGTH_ERR;
+
+    size_t nw = BITSET_WORDS(len);
+    if (layout == BITSET_BATCH_ROWS) {
+        bb->set_stride = ROUND_UP(nw, ALIGN_WORDS);
+        bb->word_stride = 1;
+    } else {
+        bb->set_stride = 1;
+        bb->word_stride = ROUND_UP(count, ALIGN_WORDS);
+    }
+    bb->count = count;
+    bb->len = len;
+    bb->layout = layout;
+
+    size_t rows = (layout == BITSET_BATCH_ROWS) ? count : nw;
+    size_t per = (layout == BITSET_BATCH_ROWS) ? bb->set_stride
+        : bb->word_stride;
+    if (rows > (SIZE_MAX - ALIGN) / sizeof(uint64_t) / per)
+        return BITSET_ALLOC_ERR;
+    size_t n = total_words(bb);
+    bb->mem = calloc(n * sizeof(uint64_t) + ALIGN, 1);
+    if (bb->mem == NULL)
+        return BITSET_ALLOC_ERR;
+
+    char *p = bb->mem;
+    bb->words = (uint64_t *)(p + (ALIGN - (uintptr_t)p % ALIGN) % ALIGN);
+    return BITSET_GOOD;
+}
+
+// Copies a bitset into a batch. 
+//
+// PARAMS: 
+// bb - the batch to change
+// j  - the index of the bitset in the batch
+// b  - the bitset to copy, as long as the bitsets of the batch
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_load(bitset_batch *bb, size_t j, const bitset *b) {
+    int ret = check_mask(bb, b);
+    if (ret != BITSET_GOOD)
+        return ret;
+    if (j >= bb->count)
+        return BITSET_RANGE_ERR;
+
+    size_t nw = BITSET_WORDS(bb->len);
+    uint64_t *w = bitset_batch_word(bb, j, 0);
+    if (bb->layout == BITSET_BATCH_ROWS) {
+        memcpy(w, b->bits, nw * sizeof(uint64_t));
+    } else {
+        for (size_t k = 0; k < nw; k++)
+            w[k * bb->word_stride] = b->bits[k];
+    }
+    return BITSET_GOOD;
+}
+
+// Copies a bitset out of a batch. 
+//
+// PARAMS: 
+// bb - the batch to read
+// j  - the index of the bitset in the batch
+// b  - the bitset to copy into, as long as the bitsets of the batch
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_store(const bitset_batch *bb, size_t j, bitset *b) {
+    int ret = check_mask(bb, b);
+    if (ret != BITSET_GOOD)
+        return ret;
+    if (j >= bb->count)
+        return BITSET_RANGE_ERR;
+
+    size_t nw = BITSET_WORDS(bb->len);
+    const uint64_t *w = bitset_batch_word(bb, j, 0);
+    if (bb->layout == BITSET_BATCH_ROWS) {
+        memcpy(b->bits, w, nw * sizeof(uint64_t));
+    } else {
+        for (size_t k = 0; k < nw; k++)
+            b->bits[k] = w[k * bb->word_stride];
+    }
+    bitset_cache_invalidate(b);
+    return BITSET_GOOD;
+}
+
+// Changes the specified bit of a bitset in a batch to 1. 
+//
+// PARAMS: 
+// bb - the batch to change
+// j  - the index of the bitset in the batch
+// i  - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_set(bitset_batch *bb, size_t j, size_t i) {
+    if (bb == NULL || bb->words == NULL)
+        return BITSET_NULL_ERR;
+    if (j >= bb->count || i >= bb->len)
+        return BITSET_RANGE_ERR;
+
+    *bitset_batch_word(bb, j, i / BITSET_WORD_LEN)
+        |= (uint64_t)1 << (i % BITSET_WORD_LEN);
+    return BITSET_GOOD;
+}
+
+// Changes the specified bit of a bitset in a batch to 0. 
+//
+// PARAMS: 
+// bb - the batch to change
+// j  - the index of the bitset in the batch
+// i  - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_clear(bitset_batch *bb, size_t j, size_t i) {
+    if (bb == NULL || bb->words == NULL)
+        return BITSET_NULL_ERR;
+    if (j >= bb->count || i >= bb->len)
+        return BITSET_RANGE_ERR;
+
+    *bitset_batch_word(bb, j, i / BITSET_WORD_LEN)
+        &= ~((uint64_t)1 << (i % BITSET_WORD_LEN));
+    return BITSET_GOOD;
+}
+
+// Determines whether the specified bit of a bitset in a batch is set to 1. 
+//
+// PARAMS: 
+// bb - the batch to test
+// j  - the index of the bitset in the batch
+// i  - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit is set to 1. False on error. 
+_Bool bitset_batch_test(const bitset_batch *bb, size_t j, size_t i) {
+    if (bb == NULL || bb->words == NULL || j >= bb->count || i >= bb->len)
+        return false;
+    return (*bitset_batch_word(bb, j, i / BITSET_WORD_LEN)
+            >> (i % BITSET_WORD_LEN)) & 1;
+}
+
+// Performs AND operation on every pair of bitsets of two batches, storing 
+// output in a third. The batches must have the same shape and layout, and 
+// the output may be one of the operands. 
+//
+// PARAMS: 
+// dst - the output batch
+// a   - the left operands
+// b   - the right operands
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_and(bitset_batch *dst, const bitset_batch *a,
+        const bitset_batch *b) {
+    int ret = check_shape(dst, a, b);
+    if (ret == BITSET_GOOD)
+        bitset_kernel->and_words(dst->words, a->words, b->words,
+                total_words(dst));
+    return ret;
+}
+
+// Performs OR operation on every pair of bitsets of two batches, storing 
+// output in a third. The batches must have the same shape and layout, and 
+// the output may be one of the operands. 
+//
+// PARAMS: 
+// dst - the output batch
+// a   - the left operands
+// b   - the right operands
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_or(bitset_batch *dst, const bitset_batch *a,
+        const bitset_batch *b) {
+    int ret = check_shape(dst, a, b);
+    if (ret == BITSET_GOOD)
+        bitset_kernel->or_words(dst->words, a->words, b->words,
+                total_words(dst));
+    return ret;
+}
+
+// Performs XOR operation on every pair of bitsets of two batches, storing 
+// output in a third. The batches must have the same shape and layout, and 
+// the output may be one of the operands. 
+//
+// PARAMS: 
+// dst - the output batch
+// a   - the left operands
+// b   - the right operands
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_xor(bitset_batch *dst, const bitset_batch *a,
+        const bitset_batch *b) {
+    int ret = check_shape(dst, a, b);
+    if (ret == BITSET_GOOD)
+        bitset_kernel->xor_words(dst->words, a->words, b->words,
+                total_words(dst));
+    return ret;
+}
+
+// Performs AND NOT operation (a & ~b) on every pair of bitsets of two 
+// batches, storing output in a third. The batches must have the same shape 
+// and layout, and the output may be one of the operands. 
+//
+// PARAMS: 
+// dst - the output batch
+// a   - the left operands
+// b   - the right operands, used inverted
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_andnot(bitset_batch *dst, const bitset_batch *a,
+        const bitset_batch *b) {
+    int ret = check_shape(dst, a, b);
+    if (ret == BITSET_GOOD)
+        bitset_kernel->andnot_words(dst->words, a->words, b->words,
+                total_words(dst));
+    return ret;
+}
+
+// Performs AND operation of every bitset of a batch with one bitset, 
+// storing output in the batch. 
+//
+// PARAMS: 
+// bb   - the batch to change
+// mask - the right operand, as long as the bitsets of the batch
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_and_mask(bitset_batch *bb, const bitset *mask) {
+    int ret = check_mask(bb, mask);
+    if (ret != BITSET_GOOD)
+        return ret;
+
+    size_t nw = BITSET_WORDS(bb->len);
+    if (bb->layout == BITSET_BATCH_COLUMNS) {
+        columns_and(bb->words, bb, mask->bits);
+    } else {
+        for (size_t j = 0; j < bb->count; j++) {
+            uint64_t *w = bitset_batch_word(bb, j, 0);
+            bitset_kernel->and_words(w, w, mask->bits, nw);
+        }
+    }
+    return BITSET_GOOD;
+}
+
+// Performs OR operation of every bitset of a batch with one bitset, storing 
+// output in the batch. 
+//
+// PARAMS: 
+// bb   - the batch to change
+// mask - the right operand, as long as the bitsets of the batch
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_or_mask(bitset_batch *bb, const bitset *mask) {
+    int ret = check_mask(bb, mask);
+    if (ret != BITSET_GOOD)
+        return ret;
+
+    size_t nw = BITSET_WORDS(bb->len);
+    if (bb->layout == BITSET_BATCH_COLUMNS) {
+        columns_or(bb->words, bb, mask->bits);
+    } else {
+        for (size_t j = 0; j < bb->count; j++) {
+            uint64_t *w = bitset_batch_word(bb, j, 0);
+            bitset_kernel->or_words(w, w, mask->bits, nw);
+        }
+    }
+    return BITSET_GOOD;
+}
+
+// Returns the number of bits set to 1 in every bitset of a batch. 
+//
+// PARAMS: 
+// bb     - the batch to count
+// counts - the output array, with room for one count per bitset
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_count(const bitset_batch *bb, size_t *counts) {
+    if (bb == NULL || bb->words == NULL || counts == NULL)
+        return BITSET_NULL_ERR;
+
+    size_t nw = BITSET_WORDS(bb->len);
+    if (bb->layout == BITSET_BATCH_COLUMNS) {
+        columns_count(bb->words, bb, NULL, counts);
+    } else {
+        for (size_t j = 0; j < bb->count; j++)
+            counts[j] = bitset_kernel->popcount(bitset_batch_word(bb, j, 0),
+                    nw);
+    }
+    return BITSET_GOOD;
+}
+
+// Returns the number of bits set to 1 in the AND of every bitset of a batch 
+// with one bitset, without storing the results. 
+//
+// PARAMS: 
+// bb     - the batch to count
+// mask   - the right operand, as long as the bitsets of the batch
+// counts - the output array, with room for one count per bitset
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_and_count(const bitset_batch *bb, const bitset *mask,
+        size_t *counts) {
+    int ret = check_mask(bb, mask);
+    if (ret != BITSET_GOOD)
+        return ret;
+    if (counts == NULL)
+        return BITSET_NULL_ERR;
+
+    size_t nw = BITSET_WORDS(bb->len);
+    if (bb->layout == BITSET_BATCH_COLUMNS) {
+        columns_count(bb->words, bb, mask->bits, counts);
+    } else {
+        for (size_t j = 0; j < bb->count; j++)
+            counts[j] = bitset_kernel->and_count(bitset_batch_word(bb, j, 0),
+                    mask->bits, nw);
+    }
+    return BITSET_GOOD;
+}
+
+// Frees the internal storage of the given batch. 
+//
+// PARAMS: 
+// bb - the batch to free
+void bitset_batch_free(bitset_batch *bb) {
+    if (bb != NULL) {
+        free(bb->mem);
+        bb->mem = NULL;
+        bb->words = NULL;
+    }
+}
+
+// Checks the batches of a batch operation. 
+//
+// PARAMS: 
+// dst - the output batch
+// a   - the left operands
+// b   - the right operands
+//
+// RET: 
+// Zero if the batches can be combined, non-zero otherwise. 
+static int check_shape(const bitset_batch *dst, const bitset_batch *a,
+        const bitset_batch *b) {
+    if (dst == NULL || a == NULL || b == NULL || dst->words == NULL
+            || a->words == NULL || b->words == NULL)
+        return BITSET_NULL_ERR;
+    if (a->count != dst->count || b->count != dst->count
+            || a->len != dst->len || b->len != dst->len
+            || a->layout != dst->layout || b->layout != dst->layout)
+        return BITSET_LENGTH_ERR;
+    return BITSET_GOOD;
+}
+
+// Checks a batch and a bitset as long as its bitsets. 
+//
+// PARAMS: 
+// bb   - the batch
+// mask - the bitset
+//
+// RET: 
+// Zero if the bitset matches the batch, non-zero otherwise. 
+static int check_mask(const bitset_batch *bb, const bitset *mask) {
+    if (bb == NULL || mask == NULL || bb->words == NULL || mask->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (mask->len != bb->len)
+        return BITSET_LENGTH_ERR;
+    return BITSET_GOOD;
+}
+
+// Returns the number of words of a batch, including the padding. 
+//
+// PARAMS: 
+// bb - the batch
+//
+// RET: 
+// The number of words. 
+static size_t total_words(const bitset_batch *bb) {
+    return (bb->layout == BITSET_BATCH_ROWS) ? bb->count * bb->set_stride
+        : BITSET_WORDS(bb->len) * bb->word_stride;
+}
+
+// Performs AND operation of every bitset of a batch in columns with a mask. 
+// The inner loop runs across the bitsets, so it vectorises. 
+//
+// PARAMS: 
+// w    - the words of the batch
+// bb   - the batch
+// mask - the words of the mask
+static void columns_and(uint64_t *restrict w, const bitset_batch *bb,
+        const uint64_t *restrict mask) {
+    size_t nw = BITSET_WORDS(bb->len), n = bb->count;
+    for (size_t k = 0; k < nw; k++, w += bb->word_stride) {
+        uint64_t m = mask[k];
+        for (size_t j = 0; j < n; j++)
+            w[j] &= m;
+    }
+}
+
+// Performs OR operation of every bitset of a batch in columns with a mask. 
+// The padding after the last bitset is left at 0. 
+//
+// PARAMS: 
+// w    - the words of the batch
+// bb   - the batch
+// mask - the words of the mask
+static void columns_or(uint64_t *restrict w, const bitset_batch *bb,
+        const uint64_t *restrict mask) {
+    size_t nw = BITSET_WORDS(bb->len), n = bb->count;
+    for (size_t k = 0; k < nw; k++, w += bb->word_stride) {
+        uint64_t m = mask[k];
+        for (size_t j = 0; j < n; j++)
+            w[j] |= m;
+    }
+}
+
+// Counts the bits set to 1 of every bitset of a batch in columns, after an 
+// AND operation with a mask. The counts of all the bitsets are kept 
+// together and updated one word at a time, so the inner loop vectorises. 
+//
+// PARAMS: 
+// w      - the words of the batch
+// bb     - the batch
+// mask   - the words of the mask, or NULL to count the bitsets alone
+// counts - the output array, one count per bitset
+static void columns_count(const uint64_t *restrict w, const bitset_batch *bb,
+        const uint64_t *restrict mask, size_t *restrict counts) {
+    size_t nw = BITSET_WORDS(bb->len), n = bb->count;
+    memset(counts, 0, n * sizeof(size_t));
+    for (size_t k = 0; k < nw; k++, w += bb->word_stride) {
+        uint64_t m = (mask != NULL) ? mask[k] : UINT64_MAX;
+        for (size_t j = 0; j < n; j++)
+            counts[j] += bitset_popcount64(w[j] & m);
+    }
+}
@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_batch.h
+// Many bitsets of the same length, stored in one block of memory. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_BATCH_H
+#define BITSET_BATCH_H
+#include "bitset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Layouts of a batch. Rows keep the words of each bitset together, which 
+// suits operations on a few bitsets at a time. Columns keep word k of every 
+// bitset together, so an operation runs across all the bitsets at once and 
+// vectorises over them. 
+#define BITSET_BATCH_ROWS 0
+#define BITSET_BATCH_COLUMNS 1
+
+// The batch type. Word k of bitset j is stored at 
+// words[j * set_stride + k * word_stride]. Rows and columns are padded to 
+// 64 bytes, and the padding and unused bits are always kept at 0. 
+typedef struct bitset_batch_t {
+    uint64_t *words;    // words of every bitset, 64-byte aligned
+    void *mem;          // memory holding the words
+    size_t count;       // number of bitsets
+    size_t len;         // length of each bitset in bits
+    size_t set_stride;  // words between two bitsets
+    size_t word_stride; // words between two words of a bitset
+    int layout;         // BITSET_BATCH_ROWS or BITSET_BATCH_COLUMNS
+} bitset_batch;
+
+// Returns a word of a bitset in a batch. Does not check the batch or the 
+// indices. 
+//
+// PARAMS: 
+// bb - the batch
+// j  - the index of the bitset
+// k  - the index of the word
+//
+// RET: 
+// The address of the word. 
+static inline uint64_t *bitset_batch_word(const bitset_batch *bb, size_t j,
+        size_t k) {
+    return bb->words + j * bb->set_stride + k * bb->word_stride;
+}
+
+// Initialises the specified batch, with every bit set to 0. 
+//
+// PARAMS: 
+// bb     - the batch to initialise
+// count  - the number of bitsets
+// len    - the length of each bitset
+// layout - BITSET_BATCH_ROWS or BITSET_BATCH_COLUMNS
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_init(bitset_batch *bb, size_t count, size_t len,
+        int layout);
+
+// Copies a bitset into a batch. 
+//
+// PARAMS: 
+// bb - the batch to change
+// j  - the index of the bitset in the batch
+// b  - the bitset to copy, as long as the bitsets of the batch
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_load(bitset_batch *bb, size_t j, const bitset *b);
+
+// Copies a bitset out of a batch. 
+//
+// PARAMS: 
+// bb - the batch to read
+// j  - the index of the bitset in the batch
+// b  - the bitset to copy into, as long as the bitsets of the batch
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_store(const bitset_batch *bb, size_t j, bitset *b);
+
+// Changes the specified bit of a bitset in a batch to 1. 
+//
+// PARAMS: 
+// bb - the batch to change
+// j  - the index of the bitset in the batch
+// i  - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_set(bitset_batch *bb, size_t j, size_t i);
+
+// Changes the specified bit of a bitset in a batch to 0. 
+//
+// PARAMS: 
+// bb - the batch to change
+// j  - the index of the bitset in the batch
+// i  - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_clear(bitset_batch *bb, size_t j, size_t i);
+
+// Determines whether the specified bit of a bitset in a batch is set to 1. 
+//
+// PARAMS: 
+// bb - the batch to test
+// j  - the index of the bitset in the batch
+// i  - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit is set to 1. False on error. 
+_Bool bitset_batch_test(const bitset_batch *bb, size_t j, size_t i);
+
+// Performs AND operation on every pair of bitsets of two batches, storing 
+// output in a third. The batches must have the same shape and layout, and 
+// the output may be one of the operands. 
+//
+// PARAMS: 
+// dst - the output batch
+// a   - the left operands
+// b   - the right operands
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_and(bitset_batch *dst, const bitset_batch *a,
+        const bitset_batch *b);
+
+// Performs OR operation on every pair of bitsets of two batches, storing 
+// output in a third. The batches must have the same shape and layout, and 
+// the output may be one of the operands. 
+//
+// PARAMS: 
+// dst - the output batch
+// a   - the left operands
+// b   - the right operands
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_or(bitset_batch *dst, const bitset_batch *a,
+        const bitset_batch *b);
+
+// Performs XOR operation on every pair of bitsets of two batches, storing 
+// output in a third. The batches must have the same shape and layout, and 
+// the output may be one of the operands. 
+//
+// PARAMS: 
+// dst - the output batch
+// a   - the left operands
+// b   - the right operands
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_xor(bitset_batch *dst, const bitset_batch *a,
+        const bitset_batch *b);
+
+// Performs AND NOT operation (a & ~b) on every pair of bitsets of two 
+// batches, storing output in a third. The batches must have the same shape 
+// and layout, and the output may be one of the operands. 
+//
+// PARAMS: 
+// dst - the output batch
+// a   - the left operands
+// b   - the right operands, used inverted
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_andnot(bitset_batch *dst, const bitset_batch *a,
+        const bitset_batch *b);
+
+// Performs AND operation of every bitset of a batch with one bitset, 
+// storing output in the batch. 
+//
+// PARAMS: 
+// bb   - the batch to change
+// mask - the right operand, as long as the bitsets of the batch
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_and_mask(bitset_batch *bb, const bitset *mask);
+
+// Performs OR operation of every bitset of a batch with one bitset, storing 
+// output in the batch. 
+//
+// PARAMS: 
+// bb   - the batch to change
+// mask - the right operand, as long as the bitsets of the batch
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_or_mask(bitset_batch *bb, const bitset *mask);
+
+// Returns the number of bits set to 1 in every bitset of a batch. 
+//
+// PARAMS: 
+// bb     - the batch to count
+// counts - the output array, with room for one count per bitset
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_count(const bitset_batch *bb, size_t *counts);
+
+// Returns the number of bits set to 1 in the AND of every bitset of a batch 
+// with one bitset, without storing the results. 
+//
+// PARAMS: 
+// bb     - the batch to count
+// mask   - the right operand, as long as the bitsets of the batch
+// counts - the output array, with room for one count per bitset
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_batch_and_count(const bitset_batch *bb, const bitset *mask,
+        size_t *counts);
+
+// Frees the internal storage of the given batch. 
+//
+// PARAMS: 
+// bb - the batch to free
+void bitset_batch_free(bitset_batch *bb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_expr.hpp
+// Lazy C++14 bitset expressions, evaluated in one fused pass. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_EXPR_HPP
+#define BITSET_EXPR_HPP
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include "bitset.hpp"
+
+namespace pm {
+
+// Number of words evaluated between checks when only any() is asked for. 
+#define BITSET_EXPR_BLOCK_WORDS 64
+
+// The base of every expression type. An expression only refers to its 
+// bitsets, which must outlive it, and computes word k of its result on 
+// demand, so a whole tree is evaluated word by word without temporaries. 
+//
+// The unused bits of the last word of an expression may be 1, so they are 
+// cleared whenever a result is stored or counted. 
+template <class E>
+class bitset_expr {
+public:
+    // Returns the expression as its own type. 
+    const E &self() const noexcept { return static_cast<const E &>(*this); }
+
+    // Evaluates the expression into a new bitset. 
+    //
+    // RET: 
+    // The bitset holding the result. 
+    dynamic_bitset eval() const {
+        dynamic_bitset out(length());
+        assign(out);
+        return out;
+    }
+
+    // Evaluates the expression into an existing bitset of the same length. 
+    // The bitset may be one of the operands. 
+    //
+    // PARAMS: 
+    // out - the bitset to store the result in
+    void assign(dynamic_bitset &out) const { assign(*out.get()); }
+
+    // Evaluates the expression into an existing C bitset of the same 
+    // length. The bitset may be one of the operands. 
+    //
+    // PARAMS: 
+    // out - the bitset to store the result in
+    void assign(::bitset &out) const {
+        std::size_t n = length();
+        if (out.bits == nullptr)
+            throw std::invalid_argument("bitset holds no bits");
+        if (out.len != n)
+            throw std::length_error("bitset length error");
+
+        std::size_t last = BITSET_WORDS(n) - 1;
+        std::uint64_t *w = out.bits;
+        for (std::size_t k = 0; k < last; k++)
+            w[k] = self().word(k);
+        w[last] = self().word(last) & tail(n);
+        bitset_cache_invalidate(&out);
+    }
+
+    // Returns the number of bits set to 1 in the result, without storing 
+    // it. 
+    std::size_t count() const {
+        std::size_t n = length(), last = BITSET_WORDS(n) - 1, c = 0;
+        for (std::size_t k = 0; k < last; k++)
+            c += bitset_popcount64(self().word(k));
+        return c + bitset_popcount64(self().word(last) & tail(n));
+    }
+
+    // Determines whether any bit of the result is set to 1, stopping at the 
+    // first block of words with a bit set to 1. 
+    bool any() const {
+        std::size_t n = length(), last = BITSET_WORDS(n) - 1;
+        for (std::size_t k = 0; k < last; k += BITSET_EXPR_BLOCK_WORDS) {
+            std::size_t end = (last - k < BITSET_EXPR_BLOCK_WORDS)
+                ? last : k + BITSET_EXPR_BLOCK_WORDS;
+            std::uint64_t v = 0;
+            for (std::size_t i = k; i < end; i++)
+                v |= self().word(i);
+            if (v != 0)
+                return true;
+        }
+        return (self().word(last) & tail(n)) != 0;
+    }
+
+    // Determines whether every bit of the result is set to 0. 
+    bool none() const { return !any(); }
+
+private:
+    // Returns the length shared by every bitset of the expression. 
+    std::size_t length() const {
+        std::size_t n = self().len();
+        if (!self().check(n))
+            throw std::length_error("bitset length error");
+        return n;
+    }
+
+    // Returns the mask of the used bits in the last word. 
+    static std::uint64_t tail(std::size_t n) noexcept {
+        return (n % BITSET_WORD_LEN == 0) ? UINT64_MAX
+            : UINT64_MAX >> (BITSET_WORD_LEN - n % BITSET_WORD_LEN);
+    }
+};
+
+// The expression reading the words of a bitset. 
+class bitset_ref : public bitset_expr<bitset_ref> {
+public:
+    // Constructs an expression reading the words of a C bitset. 
+    //
+    // PARAMS: 
+    // b - the bitset to read, which must outlive the expression
+    explicit bitset_ref(const ::bitset &b) : b_(&b) {
+        if (b.bits == nullptr)
+            throw std::invalid_argument("bitset holds no bits");
+    }
+
+    std::size_t len() const noexcept { return b_->len; }
+    bool check(std::size_t n) const noexcept { return b_->len == n; }
+    std::uint64_t word(std::size_t k) const noexcept { return b_->bits[k]; }
+
+private:
+    const ::bitset *b_;     // the bitset read
+};
+
+// The expression combining two expressions word by word. 
+template <class Op, class L, class R>
+class bitset_binary : public bitset_expr<bitset_binary<Op, L, R>> {
+public:
+    bitset_binary(const L &l, const R &r) : l_(l), r_(r) {}
+
+    std::size_t len() const noexcept { return l_.len(); }
+
+    bool check(std::size_t n) const noexcept {
+        return l_.check(n) && r_.check(n);
+    }
+
+    std::uint64_t word(std::size_t k) const noexcept {
+        return Op::apply(l_.word(k), r_.word(k));
+    }
+
+private:
+    L l_;   // the left operand
+    R r_;   // the right operand
+};
+
+// The expression inverting an expression. 
+template <class E>
+class bitset_inverse : public bitset_expr<bitset_inverse<E>> {
+public:
+    explicit bitset_inverse(const E &e) : e_(e) {}
+
+    std::size_t len() const noexcept { return e_.len(); }
+    bool check(std::size_t n) const noexcept { return e_.check(n); }
+    std::uint64_t word(std::size_t k) const noexcept { return ~e_.word(k); }
+
+private:
+    E e_;   // the operand
+};
+
+// The word operations of bitset_binary. 
+struct bitset_op_and {
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) noexcept {
+        return a & b;
+    }
+};
+
+struct bitset_op_or {
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) noexcept {
+        return a | b;
+    }
+};
+
+struct bitset_op_xor {
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) noexcept {
+        return a ^ b;
+    }
+};
+
+struct bitset_op_andnot {
+    static std::uint64_t apply(std::uint64_t a, std::uint64_t b) noexcept {
+        return a & ~b;
+    }
+};
+
+// Starts a lazy expression from a bitset. The eager operators of 
+// dynamic_bitset still apply to plain bitsets, so at least one operand of 
+// each operator must be an expression. 
+//
+// PARAMS: 
+// b - the bitset to read, which must outlive the expression
+//
+// RET: 
+// The expression reading the bitset. 
+inline bitset_ref lazy(const ::bitset &b) { return bitset_ref(b); }
+
+inline bitset_ref lazy(const dynamic_bitset &b) { return lazy(*b.get()); }
+
+// Converts an operand of an operator to an expression. 
+template <class E>
+inline const E &bitset_operand(const bitset_expr<E> &e) noexcept {
+    return e.self();
+}
+
+inline bitset_ref bitset_operand(const dynamic_bitset &b) { return lazy(b); }
+
+// Defines an operator building a bitset_binary from two expressions, or an 
+// expression and a dynamic_bitset. 
+#define BITSET_EXPR_OPERATOR(sym, op) \
+    template <class L, class R> \
+    inline bitset_binary<op, L, R> operator sym(const bitset_expr<L> &l, \
+            const bitset_expr<R> &r) { \
+        return bitset_binary<op, L, R>(l.self(), r.self()); \
+    } \
+    template <class L> \
+    inline bitset_binary<op, L, bitset_ref> operator sym( \
+            const bitset_expr<L> &l, const dynamic_bitset &r) { \
+        return bitset_binary<op, L, bitset_ref>(l.self(), lazy(r)); \
+    } \
+    template <class R> \
+    inline bitset_binary<op, bitset_ref, R> operator sym( \
+            const dynamic_bitset &l, const bitset_expr<R> &r) { \
+        return bitset_binary<op, bitset_ref, R>(lazy(l), r.self()); \
+    }
+
+BITSET_EXPR_OPERATOR(&, bitset_op_and)
+BITSET_EXPR_OPERATOR(|, bitset_op_or)
+BITSET_EXPR_OPERATOR(^, bitset_op_xor)
+
+#undef BITSET_EXPR_OPERATOR
+
+// Builds the expression l & ~r, reading each word once. 
+template <class L, class R>
+inline auto andnot(const L &l, const R &r)
+        -> bitset_binary<bitset_op_andnot,
+            typename std::decay<decltype(bitset_operand(l))>::type,
+            typename std::decay<decltype(bitset_operand(r))>::type> {
+    return { bitset_operand(l), bitset_operand(r) };
+}
+
+template <class E>
+inline bitset_inverse<E> operator~(const bitset_expr<E> &e) {
+    return bitset_inverse<E>(e.self());
+}
+
+}
+
+#endif
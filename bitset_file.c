@@ -0,0 +1,246 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_file.c
+// On-disk format for bitsets, mapped into memory without copying. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define BITSET_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include "bitset_file.h"
+#define MAGIC "PMBITSET"
+#define ORDER UINT64_C(0x0102030405060708)
+#define FNV_PRIME UINT64_C(0x100000001B3)
+#define FNV_BASIS UINT64_C(0xCBF29CE484222325)
+
+// The file header type. 
+typedef struct header_t {
+    char magic[8];          // always MAGIC
+    uint32_t version;       // format version
+    uint32_t word_len;      // bits per word
+    uint64_t order;         // ORDER, as written by the host
+    uint64_t len;           // length in bits
+    uint64_t checksum;      // checksum of the words
+    uint64_t reserved[3];   // always 0
+} header;
+
+// The mapping of a file, lent to a bitset as the context of its allocator. 
+typedef struct mapping_t {
+    bitset_allocator alloc; // lends the words, releasing releases the file
+    void *base;             // the start of the file
+    size_t size;            // the size of the file in bytes
+} mapping;
+
+static uint64_t checksum(const uint64_t *w, size_t n);
+static int check_header(const header *h, size_t size, _Bool verify);
+static void release_file(void *base, size_t size);
+static void mapping_release(void *p, size_t size, void *ctx);
+
+// Saves the specified bitset to a file. The file holds a 64-byte header 
+// (magic, version, word length, byte order, length and checksum) followed 
+// by the words in the byte order of the host. 
+//
+// PARAMS: 
+// b    - the bitset to save
+// path - the path of the file
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_save(const bitset *b, const char *path) {
+    if (b == NULL || b->bits == NULL || path == NULL)
+        return BITSET_NULL_ERR;
+
+    size_t n = BITSET_WORDS(b->len);
+    header h = { MAGIC, BITSET_FILE_VERSION, BITSET_WORD_LEN, ORDER,
+        b->len, checksum(b->bits, n), { 0, 0, 0 } };
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+        return BITSET_IO_ERR;
+
+    int ret = BITSET_GOOD;
+    if (fwrite(&h, sizeof h, 1, f) != 1
+            || fwrite(b->bits, sizeof(uint64_t), n, f) != n)
+        ret = BITSET_IO_ERR;
+    if (fclose(f) != 0)
+        ret = BITSET_IO_ERR;
+    return ret;
+}
+
+// Initialises the specified bitset by mapping a saved file copy-on-write. 
+// The bits are not copied when mapped, and pages are only copied once they 
+// are changed, so the bitset may be used like any other and the file is 
+// never modified. Growing it copies the bits to the heap and releases the 
+// file. Where memory mapping is not available, the file is read into 
+// memory instead. 
+//
+// PARAMS: 
+// b      - the bitset to initialise
+// path   - the path of the file
+// verify - whether to check the checksum, which reads every word
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_map(bitset *b, const char *path, _Bool verify) {
+    if (b == NULL || path == NULL)
+        return BITSET_NULL_ERR;
+
+    void *base = NULL;
+    size_t size = 0;
+#ifdef BITSET_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return BITSET_IO_ERR;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= BITSET_FILE_HEADER
+            && (uintmax_t)st.st_size <= SIZE_MAX) {
+        size = (size_t)st.st_size;
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (base == NULL)
+        return BITSET_FORMAT_ERR;
+    if (base == MAP_FAILED)
+        return BITSET_IO_ERR;
+#else
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+        return BITSET_IO_ERR;
+
+    long end = (fseek(f, 0, SEEK_END) == 0) ? ftell(f) : -1;
+    if (end >= BITSET_FILE_HEADER && fseek(f, 0, SEEK_SET) == 0) {
+        size = (size_t)end;
+        base = malloc(size);
+        if (base != NULL && fread(base, 1, size, f) != size) {
+            free(base);
+            base = NULL;
+        }
+    }
+    fclose(f);
+    if (base == NULL)
+        return (end < BITSET_FILE_HEADER) ? BITSET_FORMAT_ERR : BITSET_IO_ERR;
+#endif
+
+    int ret = check_header(base, size, verify);
+    mapping *m = (ret == BITSET_GOOD) ? malloc(sizeof *m) : NULL;
+    if (m == NULL) {
+        release_file(base, size);
+        return (ret == BITSET_GOOD) ? BITSET_ALLOC_ERR : ret;
+    }
+
+    m->alloc.alloc = NULL;
+    m->alloc.release = mapping_release;
+    m->alloc.ctx = m;
+    m->base = base;
+    m->size = size;
+    b->bits = (uint64_t *)((char *)base + BITSET_FILE_HEADER);
+    b->len = (size_t)((const header *)base)->len;
+    b->alloc = &m->alloc;
+    b->cap = BITSET_WORDS(b->len);
+    b->cache = NULL;
+    return BITSET_GOOD;
+}
+
+// Releases a bitset initialised by bitset_map, the same as bitset_free. 
+//
+// PARAMS: 
+// b - the bitset to release
+void bitset_unmap(bitset *b) {
+    bitset_free(b);
+}
+
+// Computes the checksum of some words, as four interleaved FNV-1a hashes 
+// so that the multiplies do not wait on each other. 
+//
+// PARAMS: 
+// w - the words to hash
+// n - the number of words
+//
+// RET: 
+// The checksum of the words. 
+static uint64_t checksum(const uint64_t *w, size_t n) {
+    uint64_t h[4] = { FNV_BASIS, FNV_BASIS + 1, FNV_BASIS + 2, FNV_BASIS + 3 };
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        h[0] = (h[0] ^ w[i]) * FNV_PRIME;
+        h[1] = (h[1] ^ w[i + 1]) * FNV_PRIME;
+        h[2] = (h[2] ^ w[i + 2]) * FNV_PRIME;
+        h[3] = (h[3] ^ w[i + 3]) * FNV_PRIME;
+    }
+    for (; i < n; i++)
+        h[0] = (h[0] ^ w[i]) * FNV_PRIME;
+
+    uint64_t ret = FNV_BASIS;
+    for (int j = 0; j < 4; j++)
+        ret = (ret ^ h[j]) * FNV_PRIME;
+    return ret;
+}
+
+// Checks the header and the size of a saved file. 
+//
+// PARAMS: 
+// h      - the header, followed by the words
+// size   - the size of the file in bytes
+// verify - whether to check the checksum
+//
+// RET: 
+// Zero if the file is valid, non-zero otherwise. 
+static int check_header(const header *h, size_t size, _Bool verify) {
+    if (memcmp(h->magic, MAGIC, sizeof h->magic) != 0
+            || h->version != BITSET_FILE_VERSION
+            || h->word_len != BITSET_WORD_LEN || h->order != ORDER
+            || h->len == 0 || h->len > SIZE_MAX - BITSET_WORD_LEN)
+        return BITSET_FORMAT_ERR;
+
+    size_t n = BITSET_WORDS((size_t)h->len);
+    if ((size - BITSET_FILE_HEADER) / sizeof(uint64_t) != n
+            || (size - BITSET_FILE_HEADER) % sizeof(uint64_t) != 0)
+        return BITSET_LENGTH_ERR;
+
+    const uint64_t *w = (const uint64_t *)((const char *)h
+            + BITSET_FILE_HEADER);
+    size_t rem = (size_t)h->len % BITSET_WORD_LEN;
+    if (rem != 0 && (w[n - 1] >> rem) != 0)
+        return BITSET_FORMAT_ERR;
+    if (verify && checksum(w, n) != h->checksum)
+        return BITSET_FORMAT_ERR;
+    return BITSET_GOOD;
+}
+
+// Releases the memory holding a file read by bitset_map. 
+//
+// PARAMS: 
+// base - the start of the file
+// size - the size of the file in bytes
+static void release_file(void *base, size_t size) {
+#ifdef BITSET_MMAP
+    munmap(base, size);
+#else
+    (void)size;
+    free(base);
+#endif
+}
+
+// Releases the words of a mapped bitset, together with the file and the 
+// mapping itself. 
+//
+// PARAMS: 
+// p    - the words, inside the file
+// size - the size of the words
+// ctx  - the mapping
+static void mapping_release(void *p, size_t size, void *ctx) {
+    mapping *m = ctx;
+    (void)p;
+    (void)size;
+    release_file(m->base, m->size);
+    free(m);
+}
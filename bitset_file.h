@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_file.h
+// On-disk format for bitsets, mapped into memory without copying. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_FILE_H
+#define BITSET_FILE_H
+#include "bitset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BITSET_FILE_VERSION 1
+
+// Size of the file header in bytes. The words follow the header, so they 
+// stay 64-byte aligned in a mapped file. 
+#define BITSET_FILE_HEADER 64
+
+// Saves the specified bitset to a file. The file holds a 64-byte header 
+// (magic, version, word length, byte order, length and checksum) followed 
+// by the words in the byte order of the host. 
+//
+// PARAMS: 
+// b    - the bitset to save
+// path - the path of the file
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_save(const bitset *b, const char *path);
+
+// Initialises the specified bitset by mapping a saved file copy-on-write. 
+// The bits are not copied when mapped, and pages are only copied once they 
+// are changed, so the bitset may be used like any other and the file is 
+// never modified. Growing it copies the bits to the heap and releases the 
+// file. Where memory mapping is not available, the file is read into 
+// memory instead. 
+//
+// PARAMS: 
+// b      - the bitset to initialise
+// path   - the path of the file
+// verify - whether to check the checksum, which reads every word
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_map(bitset *b, const char *path, _Bool verify);
+
+// Releases a bitset initialised by bitset_map, the same as bitset_free. 
+//
+// PARAMS: 
+// b - the bitset to release
+void bitset_unmap(bitset *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,166 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_fixed.h
+// Bit sets with a length fixed at compile time, kept in registers. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_FIXED_H
+#define BITSET_FIXED_H
+#include "bitset.h"
+
+// Defines a fixed-size bitset type holding a constant number of words, with 
+// static inline operations named after the type. The loops run a constant 
+// number of times, so the compiler unrolls them and keeps small bitsets in 
+// registers. Bitsets are passed and returned by value. 
+//
+// For a type named T, the operations are: 
+// T T_zero(void)                   - a bitset with every bit set to 0
+// void T_set(T *f, size_t i)       - changes bit i to 1
+// void T_clear(T *f, size_t i)     - changes bit i to 0
+// void T_flip(T *f, size_t i)      - inverts bit i
+// _Bool T_test(T f, size_t i)      - tests bit i
+// T T_and(T a, T b), T_or, T_xor   - the binary operations
+// T T_andnot(T a, T b)             - a & ~b
+// T T_not(T a)                     - inverts every bit
+// T T_lsh(T a, size_t n)           - bit i takes bit i + n, as bitset_lsh
+// T T_rsh(T a, size_t n)           - bit i takes bit i - n, as bitset_rsh
+// size_t T_count(T a)              - the number of bits set to 1
+// _Bool T_any(T a), T_all(T a)     - whether any or every bit is 1
+// _Bool T_equal(T a, T b)          - whether the bitsets are equal
+// size_t T_next_set(T a, size_t i) - the first bit set to 1 from bit i, or
+//                                    BITSET_NPOS if there is none
+// int T_load(T *f, const bitset *b) - copies from a bitset of T_LEN bits
+// int T_store(T f, bitset *b)      - copies into a bitset of T_LEN bits
+//
+// Indices are not checked. T_load and T_store return zero on success, and 
+// non-zero if the bitset is NULL or not T_LEN bits long. 
+//
+// PARAMS: 
+// T     - the name of the type
+// words - the number of 64-bit words in the type
+#define BITSET_FIXED_DEFINE(T, words) \
+    typedef struct T##_t { \
+        uint64_t w[words]; \
+    } T; \
+    enum { T##_WORDS = (words), T##_LEN = (words) * BITSET_WORD_LEN }; \
+    static inline T T##_zero(void) { \
+        T r; \
+        for (size_t k = 0; k < (words); k++) \
+            r.w[k] = 0; \
+        return r; \
+    } \
+    static inline void T##_set(T *f, size_t i) { \
+        f->w[i / BITSET_WORD_LEN] |= (uint64_t)1 << (i % BITSET_WORD_LEN); \
+    } \
+    static inline void T##_clear(T *f, size_t i) { \
+        f->w[i / BITSET_WORD_LEN] &= ~((uint64_t)1 << (i % BITSET_WORD_LEN)); \
+    } \
+    static inline void T##_flip(T *f, size_t i) { \
+        f->w[i / BITSET_WORD_LEN] ^= (uint64_t)1 << (i % BITSET_WORD_LEN); \
+    } \
+    static inline _Bool T##_test(T f, size_t i) { \
+        return (f.w[i / BITSET_WORD_LEN] >> (i % BITSET_WORD_LEN)) & 1; \
+    } \
+    BITSET_FIXED_BINARY(T, words, and, a.w[k] & b.w[k]) \
+    BITSET_FIXED_BINARY(T, words, or, a.w[k] | b.w[k]) \
+    BITSET_FIXED_BINARY(T, words, xor, a.w[k] ^ b.w[k]) \
+    BITSET_FIXED_BINARY(T, words, andnot, a.w[k] & ~b.w[k]) \
+    static inline T T##_not(T a) { \
+        for (size_t k = 0; k < (words); k++) \
+            a.w[k] = ~a.w[k]; \
+        return a; \
+    } \
+    static inline T T##_lsh(T a, size_t n) { \
+        T r; \
+        size_t q = n / BITSET_WORD_LEN, s = n % BITSET_WORD_LEN; \
+        for (size_t k = 0; k < (words); k++) { \
+            uint64_t lo = (k + q < (words)) ? a.w[k + q] : 0; \
+            uint64_t hi = (k + q + 1 < (words)) ? a.w[k + q + 1] : 0; \
+            r.w[k] = (s == 0) ? lo \
+                : (lo >> s) | (hi << (BITSET_WORD_LEN - s)); \
+        } \
+        return r; \
+    } \
+    static inline T T##_rsh(T a, size_t n) { \
+        T r; \
+        size_t q = n / BITSET_WORD_LEN, s = n % BITSET_WORD_LEN; \
+        for (size_t k = 0; k < (words); k++) { \
+            uint64_t hi = (k >= q) ? a.w[k - q] : 0; \
+            uint64_t lo = (k >= q + 1) ? a.w[k - q - 1] : 0; \
+            r.w[k] = (s == 0) ? hi \
+                : (hi << s) | (lo >> (BITSET_WORD_LEN - s)); \
+        } \
+        return r; \
+    } \
+    static inline size_t T##_count(T a) { \
+        size_t c = 0; \
+        for (size_t k = 0; k < (words); k++) \
+            c += bitset_popcount64(a.w[k]); \
+        return c; \
+    } \
+    static inline _Bool T##_any(T a) { \
+        uint64_t v = 0; \
+        for (size_t k = 0; k < (words); k++) \
+            v |= a.w[k]; \
+        return v != 0; \
+    } \
+    static inline _Bool T##_all(T a) { \
+        uint64_t v = UINT64_MAX; \
+        for (size_t k = 0; k < (words); k++) \
+            v &= a.w[k]; \
+        return v == UINT64_MAX; \
+    } \
+    static inline _Bool T##_equal(T a, T b) { \
+        uint64_t v = 0; \
+        for (size_t k = 0; k < (words); k++) \
+            v |= a.w[k] ^ b.w[k]; \
+        return v == 0; \
+    } \
+    static inline size_t T##_next_set(T a, size_t i) { \
+        if (i >= T##_LEN) \
+            return BITSET_NPOS; \
+        size_t k = i / BITSET_WORD_LEN; \
+        uint64_t v = a.w[k] & (UINT64_MAX << (i % BITSET_WORD_LEN)); \
+        while (v == 0) { \
+            if (++k == (words)) \
+                return BITSET_NPOS; \
+            v = a.w[k]; \
+        } \
+        return k * BITSET_WORD_LEN + bitset_ctz64(v); \
+    } \
+    static inline int T##_load(T *f, const bitset *b) { \
+        if (f == NULL || b == NULL || b->bits == NULL) \
+            return BITSET_NULL_ERR; \
+        if (b->len != T##_LEN) \
+            return BITSET_LENGTH_ERR; \
+        memcpy(f->w, b->bits, sizeof f->w); \
+        return BITSET_GOOD; \
+    } \
+    static inline int T##_store(T f, bitset *b) { \
+        if (b == NULL || b->bits == NULL) \
+            return BITSET_NULL_ERR; \
+        if (b->len != T##_LEN) \
+            return BITSET_LENGTH_ERR; \
+        memcpy(b->bits, f.w, sizeof f.w); \
+        bitset_cache_invalidate(b); \
+        return BITSET_GOOD; \
+    }
+
+// Defines one binary operation of BITSET_FIXED_DEFINE, with expr computing 
+// word k of the output from a and b. 
+#define BITSET_FIXED_BINARY(T, words, op, expr) \
+    static inline T T##_##op(T a, T b) { \
+        T r; \
+        for (size_t k = 0; k < (words); k++) \
+            r.w[k] = (expr); \
+        return r; \
+    }
+
+BITSET_FIXED_DEFINE(bitset64, 1)
+BITSET_FIXED_DEFINE(bitset128, 2)
+BITSET_FIXED_DEFINE(bitset256, 4)
+BITSET_FIXED_DEFINE(bitset512, 8)
+
+#endif
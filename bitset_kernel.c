@@ -0,0 +1,1069 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_kernel.c
+// Internal word kernels used by the bitset implementation. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bitset_kernel.h"
+#ifdef BITSET_X86
+#include <immintrin.h>
+#endif
+#ifdef BITSET_NEON
+#include <arm_neon.h>
+#endif
+
+// Word operations the kernels are generated from. 
+#define OP_AND(x, y) ((x) & (y))
+#define OP_OR(x, y) ((x) | (y))
+#define OP_XOR(x, y) ((x) ^ (y))
+#define OP_ANDNOT(x, y) ((x) & ~(y))
+
+// Defines a binary kernel doing dst[i] = op(a[i], b[i]) one word at a time. 
+#define BINARY_SCALAR(name, op) \
+    static void name(uint64_t *dst, const uint64_t *a, const uint64_t *b, \
+            size_t n) { \
+        for (size_t i = 0; i < n; i++) \
+            dst[i] = op(a[i], b[i]); \
+    }
+
+// Defines a kernel counting the bits set to 1 in op(a[i], b[i]) one word at 
+// a time. 
+#define COUNT_SCALAR(name, op) \
+    static size_t name(const uint64_t *a, const uint64_t *b, size_t n) { \
+        size_t ret = 0; \
+        for (size_t i = 0; i < n; i++) \
+            ret += bitset_popcount64(op(a[i], b[i])); \
+        return ret; \
+    }
+
+// Defines a kernel testing whether any op(a[i], b[i]) has a bit set to 1, 
+// one word at a time. 
+#define ANY_SCALAR(name, op) \
+    static _Bool name(const uint64_t *a, const uint64_t *b, size_t n) { \
+        for (size_t i = 0; i < n; i++) \
+            if (op(a[i], b[i])) \
+                return 1; \
+        return 0; \
+    }
+
+static size_t popcount_scalar(const uint64_t *w, size_t n);
+static void not_scalar(uint64_t *w, size_t n);
+static _Bool any_scalar(const uint64_t *w, size_t n);
+static _Bool all_scalar(const uint64_t *w, size_t n);
+static size_t to_indices_scalar(const uint64_t *w, size_t n, uint32_t *out);
+static void from_bstr_scalar(uint64_t *w, const char *s, size_t n);
+static void to_bstr_scalar(char *s, const uint64_t *w, size_t n);
+static void to_bstr_from(char *s, const uint64_t *w, size_t from, size_t n);
+BINARY_SCALAR(and_scalar, OP_AND)
+BINARY_SCALAR(or_scalar, OP_OR)
+BINARY_SCALAR(xor_scalar, OP_XOR)
+BINARY_SCALAR(andnot_scalar, OP_ANDNOT)
+COUNT_SCALAR(and_count_scalar, OP_AND)
+COUNT_SCALAR(or_count_scalar, OP_OR)
+COUNT_SCALAR(xor_count_scalar, OP_XOR)
+COUNT_SCALAR(andnot_count_scalar, OP_ANDNOT)
+ANY_SCALAR(and_any_scalar, OP_AND)
+ANY_SCALAR(andnot_any_scalar, OP_ANDNOT)
+
+#ifdef BITSET_NEON
+static void and_neon(uint64_t *dst, const uint64_t *a, const uint64_t *b,
+        size_t n);
+static void or_neon(uint64_t *dst, const uint64_t *a, const uint64_t *b,
+        size_t n);
+static void xor_neon(uint64_t *dst, const uint64_t *a, const uint64_t *b,
+        size_t n);
+static void andnot_neon(uint64_t *dst, const uint64_t *a, const uint64_t *b,
+        size_t n);
+static void not_neon(uint64_t *w, size_t n);
+#endif
+
+static bitset_kernels kernels = {
+#ifdef BITSET_NEON
+    .name = "neon",
+    .and_words = and_neon,
+    .or_words = or_neon,
+    .xor_words = xor_neon,
+    .andnot_words = andnot_neon,
+    .not_words = not_neon,
+#else
+    .name = "scalar",
+    .and_words = and_scalar,
+    .or_words = or_scalar,
+    .xor_words = xor_scalar,
+    .andnot_words = andnot_scalar,
+    .not_words = not_scalar,
+#endif
+    .popcount = popcount_scalar,
+    .and_count = and_count_scalar,
+    .or_count = or_count_scalar,
+    .xor_count = xor_count_scalar,
+    .andnot_count = andnot_count_scalar,
+    .any_words = any_scalar,
+    .all_words = all_scalar,
+    .and_any = and_any_scalar,
+    .andnot_any = andnot_any_scalar,
+    .to_indices = to_indices_scalar,
+    .from_bstr = from_bstr_scalar,
+    .to_bstr = to_bstr_scalar
+};
+
+const bitset_kernels *bitset_kernel = &kernels;
+
+const bitset_kernels bitset_kernels_scalar = {
+    .name = "scalar",
+    .and_words = and_scalar,
+    .or_words = or_scalar,
+    .xor_words = xor_scalar,
+    .andnot_words = andnot_scalar,
+    .not_words = not_scalar,
+    .popcount = popcount_scalar,
+    .and_count = and_count_scalar,
+    .or_count = or_count_scalar,
+    .xor_count = xor_count_scalar,
+    .andnot_count = andnot_count_scalar,
+    .any_words = any_scalar,
+    .all_words = all_scalar,
+    .and_any = and_any_scalar,
+    .andnot_any = andnot_any_scalar,
+    .to_indices = to_indices_scalar,
+    .from_bstr = from_bstr_scalar,
+    .to_bstr = to_bstr_scalar
+};
+
+// Counts the bits set to 1 one word at a time. 
+//
+// PARAMS: 
+// w - the words to count
+// n - the number of words
+//
+// RET: 
+// The number of bits set to 1. 
+static size_t popcount_scalar(const uint64_t *w, size_t n) {
+    size_t ret = 0;
+    for (size_t i = 0; i < n; i++)
+        ret += bitset_popcount64(w[i]);
+    return ret;
+}
+
+// Inverts every bit one word at a time. 
+//
+// PARAMS: 
+// w - the words to invert
+// n - the number of words
+static void not_scalar(uint64_t *w, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        w[i] = ~w[i];
+}
+
+// Tests whether any bit is set to 1 one word at a time. 
+//
+// PARAMS: 
+// w - the words to test
+// n - the number of words
+//
+// RET: 
+// True or false depending on whether any bit is set to 1. 
+static _Bool any_scalar(const uint64_t *w, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        if (w[i])
+            return 1;
+    return 0;
+}
+
+// Tests whether every bit is set to 1 one word at a time. 
+//
+// PARAMS: 
+// w - the words to test
+// n - the number of words
+//
+// RET: 
+// True or false depending on whether every bit is set to 1. 
+static _Bool all_scalar(const uint64_t *w, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        if (w[i] != UINT64_MAX)
+            return 0;
+    return 1;
+}
+
+// Writes the indices of bits set to 1 by clearing the lowest bit of each 
+// word until it is 0. 
+//
+// PARAMS: 
+// w   - the words to decode
+// n   - the number of words
+// out - the output array
+//
+// RET: 
+// The number of indices written. 
+static size_t to_indices_scalar(const uint64_t *w, size_t n, uint32_t *out) {
+    uint32_t *p = out;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t base = (uint32_t)(i * 64);
+        for (uint64_t v = w[i]; v != 0; v &= v - 1)
+            *p++ = base + bitset_ctz64(v);
+    }
+    return (size_t)(p - out);
+}
+
+// Sets the bits from a bit string one character at a time. 
+//
+// PARAMS: 
+// w - the words to set, all 0
+// s - the bit string
+// n - the number of characters
+static void from_bstr_scalar(uint64_t *w, const char *s, size_t n) {
+    for (size_t i = 0; i < n; i += 64) {
+        size_t k = (n - i < 64) ? n - i : 64;
+        uint64_t v = 0;
+        for (size_t j = 0; j < k; j++)
+            v |= (uint64_t)(s[i + j] == '1') << j;
+        w[i / 64] = v;
+    }
+}
+
+// Writes bits as a bit string one byte at a time. 
+//
+// PARAMS: 
+// s - the output characters
+// w - the words to write
+// n - the number of bits
+static void to_bstr_scalar(char *s, const uint64_t *w, size_t n) {
+    to_bstr_from(s, w, 0, n);
+}
+
+// Writes the bits after a position as a bit string, spreading 8 bits to 
+// 8 characters at a time with a multiply. 
+//
+// PARAMS: 
+// s    - the output characters
+// w    - the words to write
+// from - the first bit to write, a multiple of 8
+// n    - the number of bits
+static void to_bstr_from(char *s, const uint64_t *w, size_t from, size_t n) {
+    for (size_t i = from; i < n; i += 8) {
+        uint64_t x = (w[i / 64] >> (i % 64)) & 0xFF;
+        x = (x * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+        x = ((x + 0x7F7F7F7F7F7F7F7FULL) & 0x8080808080808080ULL) >> 7;
+        x |= 0x3030303030303030ULL;
+        size_t k = (n - i < 8) ? n - i : 8;
+        for (size_t j = 0; j < k; j++)
+            s[i + j] = (char)(x >> (j * 8));
+    }
+}
+
+#ifdef BITSET_NEON
+// Vector operations the NEON kernels are generated from. 
+#define V128_AND(x, y) vandq_u64(x, y)
+#define V128_OR(x, y) vorrq_u64(x, y)
+#define V128_XOR(x, y) veorq_u64(x, y)
+#define V128_ANDNOT(x, y) vbicq_u64(x, y)
+
+// Defines a binary kernel doing dst[i] = op(a[i], b[i]) with NEON, 4 words 
+// per iteration. 
+#define BINARY_NEON(name, vop, op) \
+    static void name(uint64_t *dst, const uint64_t *a, const uint64_t *b, \
+            size_t n) { \
+        size_t i = 0; \
+        for (; i + 4 <= n; i += 4) { \
+            uint64x2_t a0 = vld1q_u64(a + i), a1 = vld1q_u64(a + i + 2); \
+            uint64x2_t b0 = vld1q_u64(b + i), b1 = vld1q_u64(b + i + 2); \
+            vst1q_u64(dst + i, vop(a0, b0)); \
+            vst1q_u64(dst + i + 2, vop(a1, b1)); \
+        } \
+        for (; i < n; i++) \
+            dst[i] = op(a[i], b[i]); \
+    }
+
+BINARY_NEON(and_neon, V128_AND, OP_AND)
+BINARY_NEON(or_neon, V128_OR, OP_OR)
+BINARY_NEON(xor_neon, V128_XOR, OP_XOR)
+BINARY_NEON(andnot_neon, V128_ANDNOT, OP_ANDNOT)
+
+// Inverts every bit with NEON, 4 words per iteration. 
+//
+// PARAMS: 
+// w - the words to invert
+// n - the number of words
+static void not_neon(uint64_t *w, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t a0 = vreinterpretq_u32_u64(vld1q_u64(w + i));
+        uint32x4_t a1 = vreinterpretq_u32_u64(vld1q_u64(w + i + 2));
+        vst1q_u64(w + i, vreinterpretq_u64_u32(vmvnq_u32(a0)));
+        vst1q_u64(w + i + 2, vreinterpretq_u64_u32(vmvnq_u32(a1)));
+    }
+    for (; i < n; i++)
+        w[i] = ~w[i];
+}
+#endif
+
+#ifdef BITSET_X86
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_POPCNT __attribute__((target("popcnt")))
+#define TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#define TARGET_AVX512 __attribute__((target("avx512f,popcnt")))
+#define TARGET_AVX512BW __attribute__((target("avx512f,avx512bw")))
+#define TARGET_AVX512_POPCNT \
+    __attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+
+// Vector operations the x86 kernels are generated from. 
+#define V128_AND(x, y) _mm_and_si128(x, y)
+#define V128_OR(x, y) _mm_or_si128(x, y)
+#define V128_XOR(x, y) _mm_xor_si128(x, y)
+#define V128_ANDNOT(x, y) _mm_andnot_si128(y, x)
+#define V256_AND(x, y) _mm256_and_si256(x, y)
+#define V256_OR(x, y) _mm256_or_si256(x, y)
+#define V256_XOR(x, y) _mm256_xor_si256(x, y)
+#define V256_ANDNOT(x, y) _mm256_andnot_si256(y, x)
+#define V512_AND(x, y) _mm512_and_si512(x, y)
+#define V512_OR(x, y) _mm512_or_si512(x, y)
+#define V512_XOR(x, y) _mm512_xor_si512(x, y)
+#define V512_ANDNOT(x, y) _mm512_andnot_si512(y, x)
+
+// Returns the mask selecting the first min(n, 8) words of an AVX-512 vector. 
+#define MASK8(n) ((__mmask8)((1u << (((n) < 8) ? (n) : 8)) - 1))
+
+// Defines a binary kernel doing dst[i] = op(a[i], b[i]) with SSE2, 4 words 
+// per iteration. 
+#define BINARY_SSE2(name, vop, op) \
+    TARGET_SSE2 static void name(uint64_t *dst, const uint64_t *a, \
+            const uint64_t *b, size_t n) { \
+        size_t i = 0; \
+        for (; i + 4 <= n; i += 4) { \
+            __m128i a0 = _mm_loadu_si128((const __m128i *)(a + i)); \
+            __m128i a1 = _mm_loadu_si128((const __m128i *)(a + i + 2)); \
+            __m128i b0 = _mm_loadu_si128((const __m128i *)(b + i)); \
+            __m128i b1 = _mm_loadu_si128((const __m128i *)(b + i + 2)); \
+            _mm_storeu_si128((__m128i *)(dst + i), vop(a0, b0)); \
+            _mm_storeu_si128((__m128i *)(dst + i + 2), vop(a1, b1)); \
+        } \
+        for (; i < n; i++) \
+            dst[i] = op(a[i], b[i]); \
+    }
+
+// Defines a binary kernel doing dst[i] = op(a[i], b[i]) with AVX2, 8 words 
+// per iteration. 
+#define BINARY_AVX2(name, vop, op) \
+    TARGET_AVX2 static void name(uint64_t *dst, const uint64_t *a, \
+            const uint64_t *b, size_t n) { \
+        size_t i = 0; \
+        for (; i + 8 <= n; i += 8) { \
+            __m256i a0 = _mm256_loadu_si256((const __m256i *)(a + i)); \
+            __m256i a1 = _mm256_loadu_si256((const __m256i *)(a + i + 4)); \
+            __m256i b0 = _mm256_loadu_si256((const __m256i *)(b + i)); \
+            __m256i b1 = _mm256_loadu_si256((const __m256i *)(b + i + 4)); \
+            _mm256_storeu_si256((__m256i *)(dst + i), vop(a0, b0)); \
+            _mm256_storeu_si256((__m256i *)(dst + i + 4), vop(a1, b1)); \
+        } \
+        for (; i < n; i++) \
+            dst[i] = op(a[i], b[i]); \
+    }
+
+// Defines a binary kernel doing dst[i] = op(a[i], b[i]) with AVX-512, 
+// 16 words per iteration and a masked tail. 
+#define BINARY_AVX512(name, vop) \
+    TARGET_AVX512 static void name(uint64_t *dst, const uint64_t *a, \
+            const uint64_t *b, size_t n) { \
+        size_t i = 0; \
+        for (; i + 16 <= n; i += 16) { \
+            __m512i a0 = _mm512_loadu_si512(a + i); \
+            __m512i a1 = _mm512_loadu_si512(a + i + 8); \
+            __m512i b0 = _mm512_loadu_si512(b + i); \
+            __m512i b1 = _mm512_loadu_si512(b + i + 8); \
+            _mm512_storeu_si512(dst + i, vop(a0, b0)); \
+            _mm512_storeu_si512(dst + i + 8, vop(a1, b1)); \
+        } \
+        for (; i < n; i += 8) { \
+            __mmask8 m = MASK8(n - i); \
+            __m512i va = _mm512_maskz_loadu_epi64(m, a + i); \
+            __m512i vb = _mm512_maskz_loadu_epi64(m, b + i); \
+            _mm512_mask_storeu_epi64(dst + i, m, vop(va, vb)); \
+        } \
+    }
+
+// Defines a kernel counting the bits set to 1 in op(a[i], b[i]) using 
+// POPCNT. 
+#define COUNT_POPCNT(name, op) \
+    TARGET_POPCNT static size_t name(const uint64_t *a, const uint64_t *b, \
+            size_t n) { \
+        uint64_t c0 = 0, c1 = 0; \
+        size_t i = 0; \
+        for (; i + 2 <= n; i += 2) { \
+            c0 += (uint64_t)__builtin_popcountll(op(a[i], b[i])); \
+            c1 += (uint64_t)__builtin_popcountll(op(a[i + 1], b[i + 1])); \
+        } \
+        if (i < n) \
+            c0 += (uint64_t)__builtin_popcountll(op(a[i], b[i])); \
+        return (size_t)(c0 + c1); \
+    }
+
+// Defines a kernel counting the bits set to 1 in op(a[i], b[i]) with AVX2, 
+// 8 words per iteration. 
+#define COUNT_AVX2(name, vop, op) \
+    TARGET_AVX2 static size_t name(const uint64_t *a, const uint64_t *b, \
+            size_t n) { \
+        __m256i total = _mm256_setzero_si256(); \
+        size_t i = 0; \
+        for (; i + 8 <= n; i += 8) { \
+            __m256i a0 = _mm256_loadu_si256((const __m256i *)(a + i)); \
+            __m256i a1 = _mm256_loadu_si256((const __m256i *)(a + i + 4)); \
+            __m256i b0 = _mm256_loadu_si256((const __m256i *)(b + i)); \
+            __m256i b1 = _mm256_loadu_si256((const __m256i *)(b + i + 4)); \
+            total = _mm256_add_epi64(total, popcount256(vop(a0, b0))); \
+            total = _mm256_add_epi64(total, popcount256(vop(a1, b1))); \
+        } \
+        uint64_t lanes[4]; \
+        _mm256_storeu_si256((__m256i *)lanes, total); \
+        size_t ret = (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]); \
+        for (; i < n; i++) \
+            ret += (size_t)__builtin_popcountll(op(a[i], b[i])); \
+        return ret; \
+    }
+
+// Defines a kernel counting the bits set to 1 in op(a[i], b[i]) using 
+// AVX-512 VPOPCNTDQ, 8 words per iteration and a masked tail. 
+#define COUNT_AVX512(name, vop) \
+    TARGET_AVX512_POPCNT static size_t name(const uint64_t *a, \
+            const uint64_t *b, size_t n) { \
+        __m512i total = _mm512_setzero_si512(); \
+        for (size_t i = 0; i < n; i += 8) { \
+            __mmask8 m = MASK8(n - i); \
+            __m512i va = _mm512_maskz_loadu_epi64(m, a + i); \
+            __m512i vb = _mm512_maskz_loadu_epi64(m, b + i); \
+            total = _mm512_add_epi64(total, _mm512_popcnt_epi64(vop(va, vb))); \
+        } \
+        return (size_t)_mm512_reduce_add_epi64(total); \
+    }
+
+// Defines a kernel testing whether any op(a[i], b[i]) has a bit set to 1 
+// with SSE2, one cache line per iteration. 
+#define ANY_SSE2(name, vop, op) \
+    TARGET_SSE2 static _Bool name(const uint64_t *a, const uint64_t *b, \
+            size_t n) { \
+        const __m128i zero = _mm_setzero_si128(); \
+        size_t i = 0; \
+        for (; i + 8 <= n; i += 8) { \
+            __m128i v = vop(_mm_loadu_si128((const __m128i *)(a + i)), \
+                    _mm_loadu_si128((const __m128i *)(b + i))); \
+            for (size_t k = 2; k < 8; k += 2) \
+                v = _mm_or_si128(v, \
+                        vop(_mm_loadu_si128((const __m128i *)(a + i + k)), \
+                        _mm_loadu_si128((const __m128i *)(b + i + k)))); \
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) != 0xFFFF) \
+                return 1; \
+        } \
+        for (; i < n; i++) \
+            if (op(a[i], b[i])) \
+                return 1; \
+        return 0; \
+    }
+
+// Defines a kernel testing whether any op(a[i], b[i]) has a bit set to 1 
+// with AVX2, one cache line per iteration. 
+#define ANY_AVX2(name, vop, op) \
+    TARGET_AVX2 static _Bool name(const uint64_t *a, const uint64_t *b, \
+            size_t n) { \
+        size_t i = 0; \
+        for (; i + 8 <= n; i += 8) { \
+            __m256i a0 = _mm256_loadu_si256((const __m256i *)(a + i)); \
+            __m256i a1 = _mm256_loadu_si256((const __m256i *)(a + i + 4)); \
+            __m256i b0 = _mm256_loadu_si256((const __m256i *)(b + i)); \
+            __m256i b1 = _mm256_loadu_si256((const __m256i *)(b + i + 4)); \
+            __m256i v = _mm256_or_si256(vop(a0, b0), vop(a1, b1)); \
+            if (!_mm256_testz_si256(v, v)) \
+                return 1; \
+        } \
+        for (; i < n; i++) \
+            if (op(a[i], b[i])) \
+                return 1; \
+        return 0; \
+    }
+
+// Defines a kernel testing whether any op(a[i], b[i]) has a bit set to 1 
+// with AVX-512, one cache line per iteration and a masked tail. 
+#define ANY_AVX512(name, vop) \
+    TARGET_AVX512 static _Bool name(const uint64_t *a, const uint64_t *b, \
+            size_t n) { \
+        for (size_t i = 0; i < n; i += 8) { \
+            __mmask8 m = MASK8(n - i); \
+            __m512i va = _mm512_maskz_loadu_epi64(m, a + i); \
+            __m512i vb = _mm512_maskz_loadu_epi64(m, b + i); \
+            __m512i v = vop(va, vb); \
+            if (_mm512_test_epi64_mask(v, v)) \
+                return 1; \
+        } \
+        return 0; \
+    }
+
+// Counts the bits set to 1 in each 64-bit lane of a vector. 
+//
+// PARAMS: 
+// v - the vector to count
+//
+// RET: 
+// The number of bits set to 1 in each lane. 
+TARGET_AVX2 static inline __m256i popcount256(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, low));
+    __m256i hi = _mm256_shuffle_epi8(lut,
+            _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+BINARY_SSE2(and_sse2, V128_AND, OP_AND)
+BINARY_SSE2(or_sse2, V128_OR, OP_OR)
+BINARY_SSE2(xor_sse2, V128_XOR, OP_XOR)
+BINARY_SSE2(andnot_sse2, V128_ANDNOT, OP_ANDNOT)
+BINARY_AVX2(and_avx2, V256_AND, OP_AND)
+BINARY_AVX2(or_avx2, V256_OR, OP_OR)
+BINARY_AVX2(xor_avx2, V256_XOR, OP_XOR)
+BINARY_AVX2(andnot_avx2, V256_ANDNOT, OP_ANDNOT)
+BINARY_AVX512(and_avx512, V512_AND)
+BINARY_AVX512(or_avx512, V512_OR)
+BINARY_AVX512(xor_avx512, V512_XOR)
+BINARY_AVX512(andnot_avx512, V512_ANDNOT)
+COUNT_POPCNT(and_count_popcnt, OP_AND)
+COUNT_POPCNT(or_count_popcnt, OP_OR)
+COUNT_POPCNT(xor_count_popcnt, OP_XOR)
+COUNT_POPCNT(andnot_count_popcnt, OP_ANDNOT)
+COUNT_AVX2(and_count_avx2, V256_AND, OP_AND)
+COUNT_AVX2(or_count_avx2, V256_OR, OP_OR)
+COUNT_AVX2(xor_count_avx2, V256_XOR, OP_XOR)
+COUNT_AVX2(andnot_count_avx2, V256_ANDNOT, OP_ANDNOT)
+COUNT_AVX512(and_count_avx512, V512_AND)
+COUNT_AVX512(or_count_avx512, V512_OR)
+COUNT_AVX512(xor_count_avx512, V512_XOR)
+COUNT_AVX512(andnot_count_avx512, V512_ANDNOT)
+ANY_SSE2(and_any_sse2, V128_AND, OP_AND)
+ANY_SSE2(andnot_any_sse2, V128_ANDNOT, OP_ANDNOT)
+ANY_AVX2(and_any_avx2, V256_AND, OP_AND)
+ANY_AVX2(andnot_any_avx2, V256_ANDNOT, OP_ANDNOT)
+ANY_AVX512(and_any_avx512, V512_AND)
+ANY_AVX512(andnot_any_avx512, V512_ANDNOT)
+
+// Counts the bits set to 1 one word at a time using POPCNT. 
+//
+// PARAMS: 
+// w - the words to count
+// n - the number of words
+//
+// RET: 
+// The number of bits set to 1. 
+TARGET_POPCNT static size_t popcount_popcnt(const uint64_t *w, size_t n) {
+    uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        c0 += (uint64_t)__builtin_popcountll(w[i]);
+        c1 += (uint64_t)__builtin_popcountll(w[i + 1]);
+        c2 += (uint64_t)__builtin_popcountll(w[i + 2]);
+        c3 += (uint64_t)__builtin_popcountll(w[i + 3]);
+    }
+    for (; i < n; i++)
+        c0 += (uint64_t)__builtin_popcountll(w[i]);
+    return (size_t)(c0 + c1 + c2 + c3);
+}
+
+// Carry-save adder over three vectors. 
+//
+// PARAMS: 
+// h - the output carry bits
+// l - the output sum bits
+// a - the first vector
+// b - the second vector
+// c - the third vector
+TARGET_AVX2 static inline void csa256(__m256i *h, __m256i *l, __m256i a,
+        __m256i b, __m256i c) {
+    __m256i u = _mm256_xor_si256(a, b);
+    *h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+    *l = _mm256_xor_si256(u, c);
+}
+
+// Counts the bits set to 1 using a Harley-Seal carry-save adder tree over 
+// 16 AVX2 vectors at a time. 
+//
+// PARAMS: 
+// w - the words to count
+// n - the number of words
+//
+// RET: 
+// The number of bits set to 1. 
+TARGET_AVX2 static size_t popcount_avx2(const uint64_t *w, size_t n) {
+    const __m256i *d = (const __m256i *)w;
+    size_t nv = n / 4, i = 0;
+    __m256i total = _mm256_setzero_si256();
+    __m256i ones = total, twos = total, fours = total, eights = total;
+    __m256i sixteens, twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+
+#define LOAD(k) _mm256_loadu_si256(d + i + (k))
+    for (; i + 16 <= nv; i += 16) {
+        csa256(&twos_a, &ones, ones, LOAD(0), LOAD(1));
+        csa256(&twos_b, &ones, ones, LOAD(2), LOAD(3));
+        csa256(&fours_a, &twos, twos, twos_a, twos_b);
+        csa256(&twos_a, &ones, ones, LOAD(4), LOAD(5));
+        csa256(&twos_b, &ones, ones, LOAD(6), LOAD(7));
+        csa256(&fours_b, &twos, twos, twos_a, twos_b);
+        csa256(&eights_a, &fours, fours, fours_a, fours_b);
+        csa256(&twos_a, &ones, ones, LOAD(8), LOAD(9));
+        csa256(&twos_b, &ones, ones, LOAD(10), LOAD(11));
+        csa256(&fours_a, &twos, twos, twos_a, twos_b);
+        csa256(&twos_a, &ones, ones, LOAD(12), LOAD(13));
+        csa256(&twos_b, &ones, ones, LOAD(14), LOAD(15));
+        csa256(&fours_b, &twos, twos, twos_a, twos_b);
+        csa256(&eights_b, &fours, fours, fours_a, fours_b);
+        csa256(&sixteens, &eights, eights, eights_a, eights_b);
+        total = _mm256_add_epi64(total, popcount256(sixteens));
+    }
+#undef LOAD
+
+    total = _mm256_slli_epi64(total, 4);
+    total = _mm256_add_epi64(total,
+            _mm256_slli_epi64(popcount256(eights), 3));
+    total = _mm256_add_epi64(total,
+            _mm256_slli_epi64(popcount256(fours), 2));
+    total = _mm256_add_epi64(total,
+            _mm256_slli_epi64(popcount256(twos), 1));
+    total = _mm256_add_epi64(total, popcount256(ones));
+    for (; i < nv; i++)
+        total = _mm256_add_epi64(total,
+                popcount256(_mm256_loadu_si256(d + i)));
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    size_t ret = (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    for (i = nv * 4; i < n; i++)
+        ret += (size_t)__builtin_popcountll(w[i]);
+    return ret;
+}
+
+// Counts the bits set to 1 using AVX-512 VPOPCNTDQ. 
+//
+// PARAMS: 
+// w - the words to count
+// n - the number of words
+//
+// RET: 
+// The number of bits set to 1. 
+TARGET_AVX512_POPCNT static size_t popcount_avx512(const uint64_t *w,
+        size_t n) {
+    __m512i c0 = _mm512_setzero_si512(), c1 = c0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        c0 = _mm512_add_epi64(c0,
+                _mm512_popcnt_epi64(_mm512_loadu_si512(w + i)));
+        c1 = _mm512_add_epi64(c1,
+                _mm512_popcnt_epi64(_mm512_loadu_si512(w + i + 8)));
+    }
+    for (; i < n; i += 8) {
+        __m512i v = _mm512_maskz_loadu_epi64(MASK8(n - i), w + i);
+        c0 = _mm512_add_epi64(c0, _mm512_popcnt_epi64(v));
+    }
+    return (size_t)_mm512_reduce_add_epi64(_mm512_add_epi64(c0, c1));
+}
+
+// Inverts every bit with SSE2, 4 words per iteration. 
+//
+// PARAMS: 
+// w - the words to invert
+// n - the number of words
+TARGET_SSE2 static void not_sse2(uint64_t *w, size_t n) {
+    const __m128i all = _mm_set1_epi32(-1);
+    __m128i *d = (__m128i *)w;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4, d += 2) {
+        _mm_storeu_si128(d, _mm_xor_si128(_mm_loadu_si128(d), all));
+        _mm_storeu_si128(d + 1, _mm_xor_si128(_mm_loadu_si128(d + 1), all));
+    }
+    for (; i < n; i++)
+        w[i] = ~w[i];
+}
+
+// Inverts every bit with AVX2, 8 words per iteration. 
+//
+// PARAMS: 
+// w - the words to invert
+// n - the number of words
+TARGET_AVX2 static void not_avx2(uint64_t *w, size_t n) {
+    const __m256i all = _mm256_set1_epi32(-1);
+    __m256i *d = (__m256i *)w;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8, d += 2) {
+        _mm256_storeu_si256(d, _mm256_xor_si256(_mm256_loadu_si256(d), all));
+        _mm256_storeu_si256(d + 1,
+                _mm256_xor_si256(_mm256_loadu_si256(d + 1), all));
+    }
+    for (; i < n; i++)
+        w[i] = ~w[i];
+}
+
+// Inverts every bit with AVX-512, 16 words per iteration and a masked tail. 
+//
+// PARAMS: 
+// w - the words to invert
+// n - the number of words
+TARGET_AVX512 static void not_avx512(uint64_t *w, size_t n) {
+    const __m512i all = _mm512_set1_epi64(-1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_si512(w + i,
+                _mm512_xor_si512(_mm512_loadu_si512(w + i), all));
+        _mm512_storeu_si512(w + i + 8,
+                _mm512_xor_si512(_mm512_loadu_si512(w + i + 8), all));
+    }
+    for (; i < n; i += 8) {
+        __mmask8 m = MASK8(n - i);
+        __m512i a = _mm512_maskz_loadu_epi64(m, w + i);
+        _mm512_mask_storeu_epi64(w + i, m, _mm512_xor_si512(a, all));
+    }
+}
+
+// Tests whether any bit is set to 1 with SSE2, one cache line per 
+// iteration. 
+//
+// PARAMS: 
+// w - the words to test
+// n - the number of words
+//
+// RET: 
+// True or false depending on whether any bit is set to 1. 
+TARGET_SSE2 static _Bool any_sse2(const uint64_t *w, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_or_si128(
+                _mm_or_si128(_mm_loadu_si128((const __m128i *)(w + i)),
+                        _mm_loadu_si128((const __m128i *)(w + i + 2))),
+                _mm_or_si128(_mm_loadu_si128((const __m128i *)(w + i + 4)),
+                        _mm_loadu_si128((const __m128i *)(w + i + 6))));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) != 0xFFFF)
+            return 1;
+    }
+    for (; i < n; i++)
+        if (w[i])
+            return 1;
+    return 0;
+}
+
+// Tests whether every bit is set to 1 with SSE2, one cache line per 
+// iteration. 
+//
+// PARAMS: 
+// w - the words to test
+// n - the number of words
+//
+// RET: 
+// True or false depending on whether every bit is set to 1. 
+TARGET_SSE2 static _Bool all_sse2(const uint64_t *w, size_t n) {
+    const __m128i all = _mm_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_and_si128(
+                _mm_and_si128(_mm_loadu_si128((const __m128i *)(w + i)),
+                        _mm_loadu_si128((const __m128i *)(w + i + 2))),
+                _mm_and_si128(_mm_loadu_si128((const __m128i *)(w + i + 4)),
+                        _mm_loadu_si128((const __m128i *)(w + i + 6))));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, all)) != 0xFFFF)
+            return 0;
+    }
+    for (; i < n; i++)
+        if (w[i] != UINT64_MAX)
+            return 0;
+    return 1;
+}
+
+// Tests whether any bit is set to 1 with AVX2, one cache line per 
+// iteration. 
+//
+// PARAMS: 
+// w - the words to test
+// n - the number of words
+//
+// RET: 
+// True or false depending on whether any bit is set to 1. 
+TARGET_AVX2 static _Bool any_avx2(const uint64_t *w, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_or_si256(
+                _mm256_loadu_si256((const __m256i *)(w + i)),
+                _mm256_loadu_si256((const __m256i *)(w + i + 4)));
+        if (!_mm256_testz_si256(v, v))
+            return 1;
+    }
+    for (; i < n; i++)
+        if (w[i])
+            return 1;
+    return 0;
+}
+
+// Tests whether every bit is set to 1 with AVX2, one cache line per 
+// iteration. 
+//
+// PARAMS: 
+// w - the words to test
+// n - the number of words
+//
+// RET: 
+// True or false depending on whether every bit is set to 1. 
+TARGET_AVX2 static _Bool all_avx2(const uint64_t *w, size_t n) {
+    const __m256i all = _mm256_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)(w + i)),
+                _mm256_loadu_si256((const __m256i *)(w + i + 4)));
+        if (!_mm256_testc_si256(v, all))
+            return 0;
+    }
+    for (; i < n; i++)
+        if (w[i] != UINT64_MAX)
+            return 0;
+    return 1;
+}
+
+// Tests whether any bit is set to 1 with AVX-512, one cache line per 
+// iteration and a masked tail. 
+//
+// PARAMS: 
+// w - the words to test
+// n - the number of words
+//
+// RET: 
+// True or false depending on whether any bit is set to 1. 
+TARGET_AVX512 static _Bool any_avx512(const uint64_t *w, size_t n) {
+    for (size_t i = 0; i < n; i += 8) {
+        __m512i v = _mm512_maskz_loadu_epi64(MASK8(n - i), w + i);
+        if (_mm512_test_epi64_mask(v, v))
+            return 1;
+    }
+    return 0;
+}
+
+// Tests whether every bit is set to 1 with AVX-512, one cache line per 
+// iteration and a masked tail. 
+//
+// PARAMS: 
+// w - the words to test
+// n - the number of words
+//
+// RET: 
+// True or false depending on whether every bit is set to 1. 
+TARGET_AVX512 static _Bool all_avx512(const uint64_t *w, size_t n) {
+    const __m512i all = _mm512_set1_epi64(-1);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 m = MASK8(n - i);
+        if (_mm512_mask_cmpneq_epi64_mask(m,
+                    _mm512_maskz_loadu_epi64(m, w + i), all))
+            return 0;
+    }
+    return 1;
+}
+
+// Writes the indices of bits set to 1 with AVX-512, compressing 16 indices 
+// at a time by the bits of each word. 
+//
+// PARAMS: 
+// w   - the words to decode
+// n   - the number of words
+// out - the output array
+//
+// RET: 
+// The number of indices written. 
+TARGET_AVX512 static size_t to_indices_avx512(const uint64_t *w,
+        size_t n, uint32_t *out) {
+    const __m512i step = _mm512_set1_epi32(16);
+    __m512i base = _mm512_setr_epi32(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    uint32_t *p = out;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t v = w[i];
+        if (v == 0) {
+            base = _mm512_add_epi32(base, _mm512_slli_epi32(step, 2));
+            continue;
+        }
+        for (int k = 0; k < 4; k++, v >>= 16) {
+            __mmask16 m = (__mmask16)v;
+            unsigned c = (unsigned)__builtin_popcount(m);
+            _mm512_mask_storeu_epi32(p, (__mmask16)((1u << c) - 1),
+                    _mm512_maskz_compress_epi32(m, base));
+            p += c;
+            base = _mm512_add_epi32(base, step);
+        }
+    }
+    return (size_t)(p - out);
+}
+
+// Sets the bits from a bit string with SSE2, comparing 16 characters at a 
+// time. 
+//
+// PARAMS: 
+// w - the words to set, all 0
+// s - the bit string
+// n - the number of characters
+TARGET_SSE2 static void from_bstr_sse2(uint64_t *w, const char *s, size_t n) {
+    const __m128i one = _mm_set1_epi8('1');
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        uint64_t v = 0;
+        for (size_t k = 0; k < 4; k++) {
+            __m128i c = _mm_loadu_si128((const __m128i *)(s + i + k * 16));
+            v |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                    _mm_cmpeq_epi8(c, one)) << (k * 16);
+        }
+        w[i / 64] = v;
+    }
+    if (i < n)
+        from_bstr_scalar(w + i / 64, s + i, n - i);
+}
+
+// Sets the bits from a bit string with AVX2, comparing 32 characters at a 
+// time. 
+//
+// PARAMS: 
+// w - the words to set, all 0
+// s - the bit string
+// n - the number of characters
+TARGET_AVX2 static void from_bstr_avx2(uint64_t *w, const char *s, size_t n) {
+    const __m256i one = _mm256_set1_epi8('1');
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m256i c0 = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i c1 = _mm256_loadu_si256((const __m256i *)(s + i + 32));
+        uint32_t lo, hi;
+        lo = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c0, one));
+        hi = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c1, one));
+        w[i / 64] = ((uint64_t)hi << 32) | lo;
+    }
+    if (i < n)
+        from_bstr_scalar(w + i / 64, s + i, n - i);
+}
+
+// Writes bits as a bit string with AVX2, expanding 32 bits to 32 characters 
+// at a time. 
+//
+// PARAMS: 
+// s - the output characters
+// w - the words to write
+// n - the number of bits
+TARGET_AVX2 static void to_bstr_avx2(char *s, const uint64_t *w, size_t n) {
+    const __m256i spread = _mm256_setr_epi8(
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bit = _mm256_set1_epi64x((long long)0x8040201008040201ULL);
+    const __m256i zero = _mm256_set1_epi8('0');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        uint32_t x = (uint32_t)(w[i / 64] >> (i % 64));
+        __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32((int)x), spread);
+        v = _mm256_cmpeq_epi8(_mm256_and_si256(v, bit), bit);
+        _mm256_storeu_si256((__m256i *)(s + i), _mm256_sub_epi8(zero, v));
+    }
+    to_bstr_from(s, w, i, n);
+}
+
+// Sets the bits from a bit string with AVX-512BW, comparing 64 characters 
+// at a time and loading the tail with a mask. 
+//
+// PARAMS: 
+// w - the words to set, all 0
+// s - the bit string
+// n - the number of characters
+TARGET_AVX512BW static void from_bstr_avx512(uint64_t *w, const char *s,
+        size_t n) {
+    const __m512i one = _mm512_set1_epi8('1');
+    for (size_t i = 0; i < n; i += 64) {
+        __mmask64 m = (n - i < 64) ? ((__mmask64)1 << (n - i)) - 1 : ~0ULL;
+        __m512i c = _mm512_maskz_loadu_epi8(m, s + i);
+        w[i / 64] = (uint64_t)_mm512_cmpeq_epi8_mask(c, one);
+    }
+}
+
+// Writes bits as a bit string with AVX-512BW, blending 64 characters at a 
+// time and storing the tail with a mask. 
+//
+// PARAMS: 
+// s - the output characters
+// w - the words to write
+// n - the number of bits
+TARGET_AVX512BW static void to_bstr_avx512(char *s, const uint64_t *w,
+        size_t n) {
+    const __m512i zero = _mm512_set1_epi8('0');
+    const __m512i one = _mm512_set1_epi8('1');
+    for (size_t i = 0; i < n; i += 64) {
+        __mmask64 m = (n - i < 64) ? ((__mmask64)1 << (n - i)) - 1 : ~0ULL;
+        __m512i c = _mm512_mask_blend_epi8((__mmask64)w[i / 64], zero, one);
+        _mm512_mask_storeu_epi8(s + i, m, c);
+    }
+}
+
+// Selects the best kernels for the running CPU. Runs once before main(). 
+__attribute__((constructor)) static void kernels_select(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        kernels.name = "sse2";
+        kernels.and_words = and_sse2;
+        kernels.or_words = or_sse2;
+        kernels.xor_words = xor_sse2;
+        kernels.andnot_words = andnot_sse2;
+        kernels.not_words = not_sse2;
+        kernels.from_bstr = from_bstr_sse2;
+        kernels.any_words = any_sse2;
+        kernels.all_words = all_sse2;
+        kernels.and_any = and_any_sse2;
+        kernels.andnot_any = andnot_any_sse2;
+    }
+    if (__builtin_cpu_supports("popcnt")) {
+        kernels.popcount = popcount_popcnt;
+        kernels.and_count = and_count_popcnt;
+        kernels.or_count = or_count_popcnt;
+        kernels.xor_count = xor_count_popcnt;
+        kernels.andnot_count = andnot_count_popcnt;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.name = "avx2";
+        kernels.popcount = popcount_avx2;
+        kernels.and_words = and_avx2;
+        kernels.or_words = or_avx2;
+        kernels.xor_words = xor_avx2;
+        kernels.andnot_words = andnot_avx2;
+        kernels.not_words = not_avx2;
+        kernels.from_bstr = from_bstr_avx2;
+        kernels.to_bstr = to_bstr_avx2;
+        kernels.any_words = any_avx2;
+        kernels.all_words = all_avx2;
+        kernels.and_any = and_any_avx2;
+        kernels.andnot_any = andnot_any_avx2;
+        kernels.and_count = and_count_avx2;
+        kernels.or_count = or_count_avx2;
+        kernels.xor_count = xor_count_avx2;
+        kernels.andnot_count = andnot_count_avx2;
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels.name = "avx512";
+        kernels.and_words = and_avx512;
+        kernels.or_words = or_avx512;
+        kernels.xor_words = xor_avx512;
+        kernels.andnot_words = andnot_avx512;
+        kernels.not_words = not_avx512;
+        kernels.any_words = any_avx512;
+        kernels.all_words = all_avx512;
+        kernels.and_any = and_any_avx512;
+        kernels.andnot_any = andnot_any_avx512;
+        kernels.to_indices = to_indices_avx512;
+    }
+    if (__builtin_cpu_supports("avx512bw")) {
+        kernels.from_bstr = from_bstr_avx512;
+        kernels.to_bstr = to_bstr_avx512;
+    }
+    if (__builtin_cpu_supports("avx512vpopcntdq")) {
+        kernels.popcount = popcount_avx512;
+        kernels.and_count = and_count_avx512;
+        kernels.or_count = or_count_avx512;
+        kernels.xor_count = xor_count_avx512;
+        kernels.andnot_count = andnot_count_avx512;
+    }
+}
+#endif
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_kernel.h
+// Internal word kernels used by the bitset implementation. The best kernels 
+// for the running CPU are selected once at startup. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_KERNEL_H
+#define BITSET_KERNEL_H
+#include <stddef.h>
+#include <stdint.h>
+#include "bitset.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BITSET_X86 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define BITSET_NEON 1
+#endif
+
+// The kernel table type. The binary kernels allow dst to be the same array 
+// as a or b, but it must not overlap them in any other way. 
+typedef struct bitset_kernels_t {
+    const char *name;   // name of the instruction set used by the kernels
+
+    // counts bits set to 1
+    size_t (*popcount)(const uint64_t *w, size_t n);
+
+    // dst = a & b
+    void (*and_words)(uint64_t *dst, const uint64_t *a, const uint64_t *b,
+            size_t n);
+
+    // dst = a | b
+    void (*or_words)(uint64_t *dst, const uint64_t *a, const uint64_t *b,
+            size_t n);
+
+    // dst = a ^ b
+    void (*xor_words)(uint64_t *dst, const uint64_t *a, const uint64_t *b,
+            size_t n);
+
+    // dst = a & ~b
+    void (*andnot_words)(uint64_t *dst, const uint64_t *a, const uint64_t *b,
+            size_t n);
+
+    // w = ~w
+    void (*not_words)(uint64_t *w, size_t n);
+
+    // counts bits set to 1 in a & b
+    size_t (*and_count)(const uint64_t *a, const uint64_t *b, size_t n);
+
+    // counts bits set to 1 in a | b
+    size_t (*or_count)(const uint64_t *a, const uint64_t *b, size_t n);
+
+    // counts bits set to 1 in a ^ b
+    size_t (*xor_count)(const uint64_t *a, const uint64_t *b, size_t n);
+
+    // counts bits set to 1 in a & ~b
+    size_t (*andnot_count)(const uint64_t *a, const uint64_t *b, size_t n);
+
+    // tests whether any bit is set to 1, stopping at the first one
+    _Bool (*any_words)(const uint64_t *w, size_t n);
+
+    // tests whether every bit is set to 1, stopping at the first 0
+    _Bool (*all_words)(const uint64_t *w, size_t n);
+
+    // tests whether a & b has any bit set to 1, stopping at the first one
+    _Bool (*and_any)(const uint64_t *a, const uint64_t *b, size_t n);
+
+    // tests whether a & ~b has any bit set to 1, stopping at the first one
+    _Bool (*andnot_any)(const uint64_t *a, const uint64_t *b, size_t n);
+
+    // writes the indices of bits set to 1, returning the number written
+    size_t (*to_indices)(const uint64_t *w, size_t n, uint32_t *out);
+
+    // sets the bits of w from n characters of '0' and '1', w zeroed
+    void (*from_bstr)(uint64_t *w, const char *s, size_t n);
+
+    // writes n bits of w as characters of '0' and '1'
+    void (*to_bstr)(char *s, const uint64_t *w, size_t n);
+} bitset_kernels;
+
+// The kernels selected for the running CPU. 
+extern const bitset_kernels *bitset_kernel;
+
+// The portable C kernels, which bitset_kernel may be pointed at to compare 
+// them with the kernels selected for the running CPU. 
+extern const bitset_kernels bitset_kernels_scalar;
+
+#endif
@@ -0,0 +1,437 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_parallel.c
+// Bulk bitset operations split across a reusable thread pool. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define BITSET_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#include "bitset_parallel.h"
+#include "bitset_kernel.h"
+#define LINE_LEN 64
+#define LINE_WORDS (LINE_LEN / sizeof(uint64_t))
+#define COUNT_STRIDE (LINE_LEN / sizeof(size_t))
+
+#define OP_AND 0
+#define OP_OR 1
+#define OP_XOR 2
+#define OP_NOT 3
+#define OP_COUNT 4
+#define OP_RESET 5
+
+// The job type, describing one operation split into parts. Every part 
+// except the first starts on a cache line of the output, so no two threads 
+// write to the same line. 
+typedef struct job_t {
+    int op;                 // the operation
+    uint64_t *dst;          // output words
+    const uint64_t *src;    // right operand words, or NULL
+    size_t n;               // number of words
+    size_t head;            // number of words before the first full line
+    size_t step;            // number of words per part, a multiple of lines
+    size_t *counts;         // counts of each part, one line apart
+    size_t total;           // sum of the counts, once the job is done
+} job;
+
+#ifdef BITSET_THREADS
+// The worker type. 
+typedef struct worker_t {
+    bitset_pool *pool;      // the pool of the worker
+    size_t id;              // the part run by the worker
+    pthread_t thread;       // the thread of the worker
+} worker;
+#endif
+
+// The thread pool type. 
+struct bitset_pool_t {
+    size_t n;               // number of threads, including the caller
+    size_t *counts;         // counts of each part, one line apart
+#ifdef BITSET_THREADS
+    worker *workers;        // started workers
+    pthread_mutex_t busy;   // held by the caller running a job
+    pthread_mutex_t lock;   // guards the fields below
+    pthread_cond_t start;   // signalled when a job is posted
+    pthread_cond_t done;    // signalled when the last worker finishes
+    const job *current;     // the current job
+    unsigned long gen;      // number of jobs posted
+    size_t pending;         // number of workers still running the job
+    _Bool stop;             // whether the workers should exit
+#endif
+};
+
+static int par_binary(int op, bitset_pool *pool, bitset *lhs,
+        const bitset *rhs);
+static void run(bitset_pool *pool, job *j);
+static void run_part(const job *j, size_t part);
+#ifdef BITSET_THREADS
+static void *work(void *arg);
+static void stop(bitset_pool *pool, size_t started);
+#endif
+
+// Creates a thread pool. The calling thread always takes a share of the 
+// work, so a pool of n threads starts n - 1 workers. 
+//
+// PARAMS: 
+// pool     - the output thread pool
+// nthreads - the number of threads, or 0 for one per online CPU
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_pool_init(bitset_pool **pool, size_t nthreads) {
+    if (pool == NULL)
+        return BITSET_NULL_ERR;
+
+    if (nthreads == 0) {
+        nthreads = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        if (cpus > 0)
+            nthreads = (size_t)cpus;
+#endif
+    }
+#ifndef BITSET_THREADS
+    nthreads = 1;
+#endif
+
+    bitset_pool *p = calloc(1, sizeof *p);
+    if (p == NULL)
+        return BITSET_ALLOC_ERR;
+    p->n = nthreads;
+    p->counts = calloc(nthreads * COUNT_STRIDE, sizeof(size_t));
+    if (p->counts == NULL) {
+        free(p);
+        return BITSET_ALLOC_ERR;
+    }
+
+#ifdef BITSET_THREADS
+    p->workers = calloc(nthreads, sizeof *p->workers);
+    if (p->workers == NULL || pthread_mutex_init(&p->busy, NULL) != 0) {
+        free(p->workers);
+        free(p->counts);
+        free(p);
+        return BITSET_ALLOC_ERR;
+    }
+    if (pthread_mutex_init(&p->lock, NULL) != 0) {
+        pthread_mutex_destroy(&p->busy);
+        free(p->workers);
+        free(p->counts);
+        free(p);
+        return BITSET_ALLOC_ERR;
+    }
+    pthread_cond_init(&p->start, NULL);
+    pthread_cond_init(&p->done, NULL);
+    for (size_t i = 1; i < nthreads; i++) {
+        p->workers[i].pool = p;
+        p->workers[i].id = i;
+        if (pthread_create(&p->workers[i].thread, NULL, work,
+                &p->workers[i]) != 0) {
+            stop(p, i - 1);
+            return BITSET_ALLOC_ERR;
+        }
+    }
+#endif
+    *pool = p;
+    return BITSET_GOOD;
+}
+
+// Returns the number of threads of a thread pool, including the caller. 
+//
+// PARAMS: 
+// pool - the thread pool to check
+//
+// RET: 
+// The number of threads sharing the work. 
+size_t bitset_pool_threads(const bitset_pool *pool) {
+    return (pool == NULL) ? 1 : pool->n;
+}
+
+// Stops the workers and frees the given thread pool. 
+//
+// PARAMS: 
+// pool - the thread pool to free
+void bitset_pool_free(bitset_pool *pool) {
+    if (pool != NULL) {
+#ifdef BITSET_THREADS
+        stop(pool, pool->n - 1);
+#else
+        free(pool->counts);
+        free(pool);
+#endif
+    }
+}
+
+// Performs AND operation in parallel, storing output in the left operand. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// lhs  - the left operand
+// rhs  - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_par_and(bitset_pool *pool, bitset *lhs, const bitset *rhs) {
+    return par_binary(OP_AND, pool, lhs, rhs);
+}
+
+// Performs OR operation in parallel, storing output in the left operand. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// lhs  - the left operand
+// rhs  - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_par_or(bitset_pool *pool, bitset *lhs, const bitset *rhs) {
+    return par_binary(OP_OR, pool, lhs, rhs);
+}
+
+// Performs XOR operation in parallel, storing output in the left operand. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// lhs  - the left operand
+// rhs  - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_par_xor(bitset_pool *pool, bitset *lhs, const bitset *rhs) {
+    return par_binary(OP_XOR, pool, lhs, rhs);
+}
+
+// Performs NOT operation in parallel. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// b    - the bitset to perform NOT operation
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_par_not(bitset_pool *pool, bitset *b) {
+    if (b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+
+    size_t nw = BITSET_WORDS(b->len);
+    if (pool == NULL || pool->n == 1 || nw < BITSET_PAR_MIN_WORDS)
+        return bitset_not(b);
+
+    job j = { OP_NOT, b->bits, NULL, nw, 0, 0, NULL, 0 };
+    run(pool, &j);
+    if (b->len % BITSET_WORD_LEN != 0)
+        b->bits[nw - 1] &= UINT64_MAX >> (BITSET_WORD_LEN
+                - b->len % BITSET_WORD_LEN);
+    bitset_cache_invalidate(b);
+    return BITSET_GOOD;
+}
+
+// Returns the number of bits set to 1, counted in parallel. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// b    - the bitset to check
+//
+// RET: 
+// The number of bits that is set to 1. 
+size_t bitset_par_true_len(bitset_pool *pool, const bitset *b) {
+    if (b == NULL || b->bits == NULL)
+        return 0;
+
+    size_t nw = BITSET_WORDS(b->len);
+    if (pool == NULL || pool->n == 1 || nw < BITSET_PAR_MIN_WORDS
+            || b->cache != NULL)
+        return bitset_true_len(b);      // a cached count is cheaper
+
+    job j = { OP_COUNT, b->bits, NULL, nw, 0, 0, pool->counts, 0 };
+    run(pool, &j);
+    return j.total;
+}
+
+// Sets every bit to 0 in parallel. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// b    - the bitset to reset
+void bitset_par_reset(bitset_pool *pool, bitset *b) {
+    if (b == NULL || b->bits == NULL)
+        return;
+
+    size_t nw = BITSET_WORDS(b->len);
+    if (pool == NULL || pool->n == 1 || nw < BITSET_PAR_MIN_WORDS) {
+        bitset_reset(b);
+        return;
+    }
+
+    job j = { OP_RESET, b->bits, NULL, nw, 0, 0, NULL, 0 };
+    run(pool, &j);
+    bitset_cache_invalidate(b);
+}
+
+// Performs a binary operation in parallel, storing output in the left 
+// operand. 
+//
+// PARAMS: 
+// op   - the operation
+// pool - the thread pool to use
+// lhs  - the left operand
+// rhs  - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int par_binary(int op, bitset_pool *pool, bitset *lhs,
+        const bitset *rhs) {
+    if (lhs == NULL || rhs == NULL || lhs->bits == NULL || rhs->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (lhs->len != rhs->len)
+        return BITSET_LENGTH_ERR;
+
+    size_t nw = BITSET_WORDS(lhs->len);
+    if (pool == NULL || pool->n == 1 || nw < BITSET_PAR_MIN_WORDS) {
+        if (op == OP_AND)
+            return bitset_and(lhs, rhs);
+        return (op == OP_OR) ? bitset_or(lhs, rhs) : bitset_xor(lhs, rhs);
+    }
+
+    job j = { op, lhs->bits, rhs->bits, nw, 0, 0, NULL, 0 };
+    run(pool, &j);
+    bitset_cache_invalidate(lhs);
+    return BITSET_GOOD;
+}
+
+// Splits a job into one part per thread and runs it, returning once every 
+// part is done. Jobs posted by several threads at once run one at a time, 
+// and the counts of a job are added up before the next one starts. 
+//
+// PARAMS: 
+// pool - the thread pool to run on
+// j    - the job to run, with its partition filled in here
+static void run(bitset_pool *pool, job *j) {
+    size_t mis = (size_t)((uintptr_t)j->dst % LINE_LEN) / sizeof(uint64_t);
+    j->head = (LINE_WORDS - mis) % LINE_WORDS;
+    if (j->head > j->n)
+        j->head = j->n;
+    j->step = (j->n - j->head + pool->n - 1) / pool->n;
+    j->step = (j->step + LINE_WORDS - 1) / LINE_WORDS * LINE_WORDS;
+
+#ifdef BITSET_THREADS
+    pthread_mutex_lock(&pool->busy);
+    pthread_mutex_lock(&pool->lock);
+    pool->current = j;
+    pool->gen++;
+    pool->pending = pool->n - 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_part(j, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+#else
+    for (size_t i = 0; i < pool->n; i++)
+        run_part(j, i);
+#endif
+
+    for (size_t i = 0; j->counts != NULL && i < pool->n; i++)
+        j->total += j->counts[i * COUNT_STRIDE];
+#ifdef BITSET_THREADS
+    pthread_mutex_unlock(&pool->busy);
+#endif
+}
+
+// Runs one part of a job. 
+//
+// PARAMS: 
+// j    - the job to run
+// part - the index of the part
+static void run_part(const job *j, size_t part) {
+    size_t lo = (part == 0) ? 0 : j->head + part * j->step;
+    size_t hi = j->head + (part + 1) * j->step;
+    lo = (lo < j->n) ? lo : j->n;
+    hi = (hi < j->n) ? hi : j->n;
+
+    uint64_t *dst = j->dst + lo;
+    const uint64_t *src = (j->src == NULL) ? NULL : j->src + lo;
+    size_t n = hi - lo;
+    switch (j->op) {
+    case OP_AND:
+        bitset_kernel->and_words(dst, dst, src, n);
+        break;
+    case OP_OR:
+        bitset_kernel->or_words(dst, dst, src, n);
+        break;
+    case OP_XOR:
+        bitset_kernel->xor_words(dst, dst, src, n);
+        break;
+    case OP_NOT:
+        bitset_kernel->not_words(dst, n);
+        break;
+    case OP_COUNT:
+        j->counts[part * COUNT_STRIDE] = bitset_kernel->popcount(dst, n);
+        break;
+    default:
+        memset(dst, 0, n * sizeof(uint64_t));
+        break;
+    }
+}
+
+#ifdef BITSET_THREADS
+// Runs the part of every posted job belonging to a worker until the pool 
+// is stopped. 
+//
+// PARAMS: 
+// arg - the worker
+//
+// RET: 
+// Always NULL. 
+static void *work(void *arg) {
+    worker *w = arg;
+    bitset_pool *pool = w->pool;
+    unsigned long seen = 0;     // the pool starts at 0, before any job
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->gen == seen && !pool->stop)
+            pthread_cond_wait(&pool->start, &pool->lock);
+        if (pool->stop)
+            break;
+
+        seen = pool->gen;
+        const job *j = pool->current;
+        pthread_mutex_unlock(&pool->lock);
+        run_part(j, w->id);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0)
+            pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+// Stops the started workers of a thread pool and frees it. 
+//
+// PARAMS: 
+// pool    - the thread pool to free
+// started - the number of workers started
+static void stop(bitset_pool *pool, size_t started) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 1; i <= started; i++)
+        pthread_join(pool->workers[i].thread, NULL);
+
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->busy);
+    free(pool->workers);
+    free(pool->counts);
+    free(pool);
+}
+#endif
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_parallel.h
+// Bulk bitset operations split across a reusable thread pool. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_PARALLEL_H
+#define BITSET_PARALLEL_H
+#include "bitset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bitsets with fewer words than this are processed by the calling thread 
+// alone, as waking the pool would cost more than it saves. 
+#define BITSET_PAR_MIN_WORDS 131072
+
+// The thread pool type. Several threads may post jobs to one pool, which 
+// runs them one at a time. 
+typedef struct bitset_pool_t bitset_pool;
+
+// Creates a thread pool. The calling thread always takes a share of the 
+// work, so a pool of n threads starts n - 1 workers. 
+//
+// PARAMS: 
+// pool     - the output thread pool
+// nthreads - the number of threads, or 0 for one per online CPU
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_pool_init(bitset_pool **pool, size_t nthreads);
+
+// Returns the number of threads of a thread pool, including the caller. 
+//
+// PARAMS: 
+// pool - the thread pool to check
+//
+// RET: 
+// The number of threads sharing the work. 
+size_t bitset_pool_threads(const bitset_pool *pool);
+
+// Stops the workers and frees the given thread pool. 
+//
+// PARAMS: 
+// pool - the thread pool to free
+void bitset_pool_free(bitset_pool *pool);
+
+// Performs AND operation in parallel, storing output in the left operand. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// lhs  - the left operand
+// rhs  - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_par_and(bitset_pool *pool, bitset *lhs, const bitset *rhs);
+
+// Performs OR operation in parallel, storing output in the left operand. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// lhs  - the left operand
+// rhs  - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_par_or(bitset_pool *pool, bitset *lhs, const bitset *rhs);
+
+// Performs XOR operation in parallel, storing output in the left operand. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// lhs  - the left operand
+// rhs  - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_par_xor(bitset_pool *pool, bitset *lhs, const bitset *rhs);
+
+// Performs NOT operation in parallel. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// b    - the bitset to perform NOT operation
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_par_not(bitset_pool *pool, bitset *b);
+
+// Returns the number of bits set to 1, counted in parallel. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// b    - the bitset to check
+//
+// RET: 
+// The number of bits that is set to 1. 
+size_t bitset_par_true_len(bitset_pool *pool, const bitset *b);
+
+// Sets every bit to 0 in parallel. 
+//
+// PARAMS: 
+// pool - the thread pool to use
+// b    - the bitset to reset
+void bitset_par_reset(bitset_pool *pool, bitset *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
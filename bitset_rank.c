@@ -0,0 +1,238 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_rank.c
+// Rank and select index over a bitset. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bitset_rank.h"
+#include "bitset_kernel.h"
+#if defined(__GNUC__) && defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#define WORD_LEN BITSET_WORD_LEN
+#define BLOCK_WORDS 32
+#define SUB_WORDS 8
+#define SUB_BITS 10
+#define CHUNK_BLOCKS ((size_t)1 << 21)    // blocks per 2^32 bits
+#define SAMPLE 8192
+
+// Returns the number of bits set to 1 before block e. 
+#define BLOCK_START(r, e) \
+    ((r)->top[(e) / CHUNK_BLOCKS] + (uint32_t)(r)->blocks[e])
+
+// Returns the count of sub-block s of a block entry, for s below 3. 
+#define SUB_COUNT(entry, s) \
+    (((entry) >> (32 + (s) * SUB_BITS)) & ((1u << SUB_BITS) - 1))
+
+static int build(bitset_rank_index *r);
+static size_t select64(uint64_t w, size_t k);
+
+// Initialises a rank index over the specified bitset, and builds it. 
+//
+// PARAMS: 
+// r - the rank index to initialise
+// b - the bitset to index, which must outlive the index
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_rank_init(bitset_rank_index *r, const bitset *b) {
+    if (r == NULL || b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+
+    r->b = b;
+    r->top = NULL;
+    r->blocks = NULL;
+    r->samples = NULL;
+    r->ones = 0;
+    r->dirty = true;
+    return build(r);
+}
+
+// Marks a rank index out of date after its bitset changed in any way, 
+// including a resize. The next query rebuilds it. 
+//
+// PARAMS: 
+// r - the rank index to invalidate
+void bitset_rank_invalidate(bitset_rank_index *r) {
+    if (r != NULL)
+        r->dirty = true;
+}
+
+// Returns the number of bits set to 1 before the specified position. 
+//
+// PARAMS: 
+// r - the rank index to query
+// i - the position, at most the length of the bitset
+//
+// RET: 
+// The number of bits set to 1 before i, or BITSET_NPOS on error. 
+size_t bitset_rank(bitset_rank_index *r, size_t i) {
+    if (r == NULL || (r->dirty && build(r) != BITSET_GOOD))
+        return BITSET_NPOS;
+    if (i >= r->b->len)
+        return (i == r->b->len) ? r->ones : BITSET_NPOS;
+
+    const uint64_t *w = r->b->bits;
+    size_t e = i / (BLOCK_WORDS * WORD_LEN);
+    size_t sub = (i / (SUB_WORDS * WORD_LEN)) % (BLOCK_WORDS / SUB_WORDS);
+    size_t ret = BLOCK_START(r, e);
+    for (size_t s = 0; s < sub; s++)
+        ret += SUB_COUNT(r->blocks[e], s);
+    for (size_t j = e * BLOCK_WORDS + sub * SUB_WORDS; j < i / WORD_LEN; j++)
+        ret += bitset_popcount64(w[j]);
+    uint64_t below = ((uint64_t)1 << (i % WORD_LEN)) - 1;
+    return ret + bitset_popcount64(w[i / WORD_LEN] & below);
+}
+
+// Returns the position of the specified bit set to 1. 
+//
+// PARAMS: 
+// r - the rank index to query
+// k - which bit set to 1 to find, counting from 0
+//
+// RET: 
+// The position of the kth bit set to 1, or BITSET_NPOS if there are not 
+// that many or on error. 
+size_t bitset_select(bitset_rank_index *r, size_t k) {
+    if (r == NULL || (r->dirty && build(r) != BITSET_GOOD) || k >= r->ones)
+        return BITSET_NPOS;
+
+    // the samples bound the blocks holding the kth bit set to 1
+    size_t nb = (BITSET_WORDS(r->b->len) + BLOCK_WORDS - 1) / BLOCK_WORDS;
+    size_t j = k / SAMPLE;
+    size_t lo = r->samples[j];
+    size_t hi = (j + 1 < (r->ones + SAMPLE - 1) / SAMPLE)
+        ? r->samples[j + 1] + 1 : nb;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (BLOCK_START(r, mid) <= k)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    size_t rem = k - BLOCK_START(r, lo), sub = 0;
+    for (; sub < 3 && SUB_COUNT(r->blocks[lo], sub) <= rem; sub++)
+        rem -= SUB_COUNT(r->blocks[lo], sub);
+
+    const uint64_t *w = r->b->bits;
+    size_t i = lo * BLOCK_WORDS + sub * SUB_WORDS;
+    for (;; i++) {
+        size_t c = bitset_popcount64(w[i]);
+        if (rem < c)
+            break;
+        rem -= c;
+    }
+    return i * WORD_LEN + select64(w[i], rem);
+}
+
+// Frees the given rank index. 
+//
+// PARAMS: 
+// r - the rank index to free
+void bitset_rank_free(bitset_rank_index *r) {
+    if (r != NULL) {
+        free(r->top);
+        free(r->blocks);
+        free(r->samples);
+        r->top = NULL;
+        r->blocks = NULL;
+        r->samples = NULL;
+        r->dirty = true;
+    }
+}
+
+// Builds the counts and samples of a rank index from its bitset. 
+//
+// PARAMS: 
+// r - the rank index to build
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int build(bitset_rank_index *r) {
+    const uint64_t *w = r->b->bits;
+    size_t nw = BITSET_WORDS(r->b->len);
+    size_t nb = (nw + BLOCK_WORDS - 1) / BLOCK_WORDS;
+    size_t nt = (nb + CHUNK_BLOCKS - 1) / CHUNK_BLOCKS;
+    uint64_t *top = malloc(nt * sizeof *top);
+    uint64_t *blocks = malloc(nb * sizeof *blocks);
+    if (top == NULL || blocks == NULL) {
+        free(top);
+        free(blocks);
+        return BITSET_ALLOC_ERR;
+    }
+
+    size_t ones = 0;
+    uint32_t cum = 0;
+    for (size_t e = 0; e < nb; e++) {
+        if (e % CHUNK_BLOCKS == 0) {
+            top[e / CHUNK_BLOCKS] = ones;
+            cum = 0;
+        }
+
+        uint64_t entry = cum;
+        for (size_t s = 0; s < BLOCK_WORDS / SUB_WORDS; s++) {
+            size_t from = e * BLOCK_WORDS + s * SUB_WORDS, c = 0;
+            if (from < nw) {
+                size_t n = (nw - from < SUB_WORDS) ? nw - from : SUB_WORDS;
+                c = bitset_kernel->popcount(w + from, n);
+            }
+            if (s < 3)
+                entry |= (uint64_t)c << (32 + s * SUB_BITS);
+            cum += (uint32_t)c;
+            ones += c;
+        }
+        blocks[e] = entry;
+    }
+
+    size_t ns = (ones + SAMPLE - 1) / SAMPLE;
+    size_t *samples = malloc((ns > 0 ? ns : 1) * sizeof *samples);
+    if (samples == NULL) {
+        free(top);
+        free(blocks);
+        return BITSET_ALLOC_ERR;
+    }
+    free(r->top);
+    free(r->blocks);
+    r->top = top;                   // BLOCK_START reads the new counts
+    r->blocks = blocks;
+    for (size_t e = 0, j = 0; j < ns; e++) {
+        size_t end = (e + 1 < nb) ? BLOCK_START(r, e + 1) : ones;
+        while (j < ns && j * SAMPLE < end)
+            samples[j++] = e;
+    }
+
+    free(r->samples);
+    r->samples = samples;
+    r->ones = ones;
+    r->dirty = false;
+    return BITSET_GOOD;
+}
+
+// Returns the position of the kth bit set to 1 in a word. 
+//
+// PARAMS: 
+// w - the word to search
+// k - which bit set to 1 to find, less than the number of bits set to 1
+//
+// RET: 
+// The position of the bit within the word. 
+static size_t select64(uint64_t w, size_t k) {
+#if defined(__GNUC__) && defined(__BMI2__)
+    return bitset_ctz64(_pdep_u64((uint64_t)1 << k, w));
+#else
+    size_t pos = 0;
+    for (;; pos += 8) {
+        size_t c = bitset_popcount64((w >> pos) & 0xFF);
+        if (k < c)
+            break;
+        k -= c;
+    }
+    uint64_t v = w >> pos;
+    for (; k > 0; k--)
+        v &= v - 1;
+    return pos + bitset_ctz64(v);
+#endif
+}
@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_rank.h
+// Rank and select index over a bitset. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_RANK_H
+#define BITSET_RANK_H
+#include "bitset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The rank index type. Counts are kept per 2048-bit block, split in four 
+// 512-bit sub-blocks, in one 64-bit entry per block (about 3% of the 
+// bitset), plus the block of every 8192th bit set to 1 for select. The 
+// index is rebuilt on the next query once invalidated. 
+typedef struct bitset_rank_index_t {
+    const bitset *b;    // the indexed bitset
+    uint64_t *top;      // counts before each 2^32-bit chunk
+    uint64_t *blocks;   // count before each block within its chunk, and
+                        // the counts of its first three sub-blocks
+    size_t *samples;    // block of every 8192th bit set to 1
+    size_t ones;        // number of bits set to 1
+    _Bool dirty;        // whether the index must be rebuilt
+} bitset_rank_index;
+
+// Initialises a rank index over the specified bitset, and builds it. 
+//
+// PARAMS: 
+// r - the rank index to initialise
+// b - the bitset to index, which must outlive the index
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_rank_init(bitset_rank_index *r, const bitset *b);
+
+// Marks a rank index out of date after its bitset changed in any way, 
+// including a resize. The next query rebuilds it. 
+//
+// PARAMS: 
+// r - the rank index to invalidate
+void bitset_rank_invalidate(bitset_rank_index *r);
+
+// Returns the number of bits set to 1 before the specified position. 
+//
+// PARAMS: 
+// r - the rank index to query
+// i - the position, at most the length of the bitset
+//
+// RET: 
+// The number of bits set to 1 before i, or BITSET_NPOS on error. 
+size_t bitset_rank(bitset_rank_index *r, size_t i);
+
+// Returns the position of the specified bit set to 1. 
+//
+// PARAMS: 
+// r - the rank index to query
+// k - which bit set to 1 to find, counting from 0
+//
+// RET: 
+// The position of the kth bit set to 1, or BITSET_NPOS if there are not 
+// that many or on error. 
+size_t bitset_select(bitset_rank_index *r, size_t k);
+
+// Frees the given rank index. 
+//
+// PARAMS: 
+// r - the rank index to free
+void bitset_rank_free(bitset_rank_index *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
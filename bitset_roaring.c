@@ -0,0 +1,1061 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_roaring.c
+// Compressed bit set for sparse and run-heavy sets of 32-bit indices. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bitset_roaring.h"
+#include "bitset_kernel.h"
+#define CHUNK_LEN 65536
+#define CHUNK_WORDS (CHUNK_LEN / BITSET_WORD_LEN)
+#define ARRAY_MAX 4096
+
+#define TYPE_ARRAY 0
+#define TYPE_BITMAP 1
+#define TYPE_RUN 2
+
+#define OP_AND 0
+#define OP_OR 1
+#define OP_XOR 2
+#define OP_ANDNOT 3
+
+// Casts the data of a container to its type. 
+#define ARRAY(c) ((uint16_t *)(c)->data)
+#define BITMAP(c) ((uint64_t *)(c)->data)
+#define RUNS(c) ((run *)(c)->data)
+
+// A run of consecutive bits set to 1. 
+typedef struct run_t {
+    uint16_t start;     // first bit of the run
+    uint16_t last;      // last bit of the run
+} run;
+
+// The container type, holding the bits of one chunk. 
+typedef struct bitset_container_t {
+    uint32_t key;       // index of the chunk
+    uint32_t type;      // storage type
+    uint32_t card;      // number of bits set to 1
+    uint32_t size;      // number of values or runs in use
+    uint32_t cap;       // number of values or runs allocated
+    void *data;         // values, words or runs
+} container;
+
+static int c_reserve(container *c, uint32_t n);
+static int c_from_words(container *c, uint32_t key, const uint64_t *w);
+static void c_to_words(const container *c, uint64_t *w);
+static int c_copy(container *dst, const container *src);
+static int c_unrun(container *c);
+static int c_runify(container *c, uint32_t nruns);
+static uint32_t c_runs(const container *c);
+static _Bool c_test(const container *c, uint16_t v);
+static int c_add(container *c, uint16_t v);
+static int c_remove(container *c, uint16_t v);
+static int c_op(int op, const container *a, const container *b,
+        container *out);
+static int array_op(int op, const container *a, const container *b,
+        container *out);
+static int array_filter(const container *a, const container *b,
+        _Bool keep, container *out);
+static int run_op(int op, const container *a, const container *b,
+        container *out);
+static void c_free(container *c);
+static void words_set_range(uint64_t *w, size_t lo, size_t hi);
+static size_t find(const bitset_roaring *r, uint32_t key);
+static int insert(bitset_roaring *r, size_t pos, uint32_t key);
+static void erase(bitset_roaring *r, size_t pos);
+static int roaring_op(int op, bitset_roaring *lhs, const bitset_roaring *rhs);
+
+// Initialises the specified compressed bitset, with every bit set to 0. 
+//
+// PARAMS: 
+// r - the compressed bitset to initialise
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_init(bitset_roaring *r) {
+    if (r == NULL)
+        return BITSET_NULL_ERR;
+
+    r->cs = NULL;
+    r->n = 0;
+    r->cap = 0;
+    return BITSET_GOOD;
+}
+
+// Initialises the specified compressed bitset from a bitset. The bitset must 
+// be at most 2^32 bits long. 
+//
+// PARAMS: 
+// r - the compressed bitset to initialise
+// b - the bitset to initialise from
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_init_bitset(bitset_roaring *r, const bitset *b) {
+    if (r == NULL || b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+    if (b->len - 1 > UINT32_MAX)
+        return BITSET_LENGTH_ERR;
+
+    int ret = bitset_roaring_init(r);
+    size_t nw = BITSET_WORDS(b->len);
+    uint64_t w[CHUNK_WORDS];
+    for (size_t i = 0; i < nw && ret == BITSET_GOOD; i += CHUNK_WORDS) {
+        size_t k = (nw - i < CHUNK_WORDS) ? nw - i : CHUNK_WORDS;
+        if (!bitset_kernel->any_words(b->bits + i, k))
+            continue;
+
+        memcpy(w, b->bits + i, k * sizeof(uint64_t));
+        memset(w + k, 0, (CHUNK_WORDS - k) * sizeof(uint64_t));
+        ret = insert(r, r->n, (uint32_t)(i / CHUNK_WORDS));
+        if (ret == BITSET_GOOD)
+            ret = c_from_words(&r->cs[r->n - 1], r->cs[r->n - 1].key, w);
+    }
+    if (ret != BITSET_GOOD)
+        bitset_roaring_free(r);
+    return ret;
+}
+
+// Writes a compressed bitset into an initialised bitset, replacing its bits. 
+//
+// PARAMS: 
+// r - the compressed bitset to write
+// b - the bitset to write into, long enough to hold every bit set to 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_to_bitset(const bitset_roaring *r, bitset *b) {
+    if (r == NULL || b == NULL || b->bits == NULL)
+        return BITSET_NULL_ERR;
+
+    if (r->n > 0) {
+        const container *c = &r->cs[r->n - 1];
+        uint64_t w[CHUNK_WORDS];
+        c_to_words(c, w);
+        size_t i = CHUNK_WORDS;
+        while (w[i - 1] == 0)
+            i--;
+        size_t max = (size_t)c->key * CHUNK_LEN + (i - 1) * BITSET_WORD_LEN
+            + (BITSET_WORD_LEN - 1 - bitset_clz64(w[i - 1]));
+        if (max >= b->len)
+            return BITSET_RANGE_ERR;
+    }
+
+    size_t nw = BITSET_WORDS(b->len);
+    bitset_reset(b);
+    for (size_t i = 0; i < r->n; i++) {
+        const container *c = &r->cs[i];
+        uint64_t *dst = b->bits + (size_t)c->key * CHUNK_WORDS;
+        size_t base = (size_t)c->key * CHUNK_LEN;
+        if (c->type == TYPE_ARRAY) {
+            for (uint32_t j = 0; j < c->size; j++)
+                bitset_set(b, base + ARRAY(c)[j]);
+        } else if (c->type == TYPE_BITMAP) {
+            size_t k = nw - (size_t)c->key * CHUNK_WORDS;
+            memcpy(dst, BITMAP(c),
+                    ((k < CHUNK_WORDS) ? k : CHUNK_WORDS) * sizeof(uint64_t));
+        } else {
+            for (uint32_t j = 0; j < c->size; j++)
+                words_set_range(b->bits, base + RUNS(c)[j].start,
+                        base + RUNS(c)[j].last);
+        }
+    }
+    bitset_cache_invalidate(b);
+    return BITSET_GOOD;
+}
+
+// Changes the specified bit to 1. 
+//
+// PARAMS: 
+// r - the compressed bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_set(bitset_roaring *r, uint32_t i) {
+    if (r == NULL)
+        return BITSET_NULL_ERR;
+
+    size_t pos = find(r, i >> 16);
+    if (pos == r->n || r->cs[pos].key != i >> 16) {
+        if (insert(r, pos, i >> 16) != BITSET_GOOD)
+            return BITSET_ALLOC_ERR;
+    }
+
+    int ret = c_add(&r->cs[pos], (uint16_t)i);
+    if (r->cs[pos].card == 0)
+        erase(r, pos);
+    return ret;
+}
+
+// Changes the specified bit to 0. 
+//
+// PARAMS: 
+// r - the compressed bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_clear(bitset_roaring *r, uint32_t i) {
+    if (r == NULL)
+        return BITSET_NULL_ERR;
+
+    int ret = BITSET_GOOD;
+    size_t pos = find(r, i >> 16);
+    if (pos < r->n && r->cs[pos].key == i >> 16) {
+        ret = c_remove(&r->cs[pos], (uint16_t)i);
+        if (r->cs[pos].card == 0)
+            erase(r, pos);
+    }
+    return ret;
+}
+
+// Determines whether the specified bit is set to 1. 
+//
+// PARAMS: 
+// r - the compressed bitset to test
+// i - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit is set to 1. 
+_Bool bitset_roaring_test(const bitset_roaring *r, uint32_t i) {
+    if (r == NULL)
+        return false;
+
+    size_t pos = find(r, i >> 16);
+    return pos < r->n && r->cs[pos].key == i >> 16
+        && c_test(&r->cs[pos], (uint16_t)i);
+}
+
+// Changes a range of bits to 1. Whole chunks in the range are stored as a 
+// single run. 
+//
+// PARAMS: 
+// r   - the compressed bitset to change
+// pos - the first bit of the range
+// n   - the number of bits in the range, with pos + n at most 2^32
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_set_range(bitset_roaring *r, uint32_t pos, uint64_t n) {
+    if (r == NULL)
+        return BITSET_NULL_ERR;
+    if (n > ((uint64_t)1 << 32) - pos)
+        return BITSET_RANGE_ERR;
+
+    int ret = BITSET_GOOD;
+    uint64_t end = (uint64_t)pos + n;
+    for (uint64_t i = pos; i < end && ret == BITSET_GOOD; ) {
+        uint32_t key = (uint32_t)(i >> 16);
+        uint64_t stop = ((uint64_t)key + 1) << 16;
+        uint32_t lo = (uint32_t)(i & 0xFFFF);
+        uint32_t hi = (uint32_t)(((end < stop) ? end : stop) - 1) & 0xFFFF;
+        size_t at = find(r, key);
+        _Bool found = at < r->n && r->cs[at].key == key;
+
+        if (!found || (lo == 0 && hi == CHUNK_LEN - 1)) {
+            container c = { key, TYPE_RUN, hi - lo + 1, 1, 0, NULL };
+            ret = c_reserve(&c, 1);
+            if (ret == BITSET_GOOD) {
+                RUNS(&c)[0].start = (uint16_t)lo;
+                RUNS(&c)[0].last = (uint16_t)hi;
+                if (!found)
+                    ret = insert(r, at, key);
+                if (ret == BITSET_GOOD) {
+                    c_free(&r->cs[at]);
+                    r->cs[at] = c;
+                } else {
+                    c_free(&c);
+                }
+            }
+        } else {
+            uint64_t w[CHUNK_WORDS];
+            c_to_words(&r->cs[at], w);
+            words_set_range(w, lo, hi);
+            container c;
+            ret = c_from_words(&c, key, w);
+            if (ret == BITSET_GOOD) {
+                c_free(&r->cs[at]);
+                r->cs[at] = c;
+            }
+        }
+        i = stop;
+    }
+    return ret;
+}
+
+// Returns the number of bits set to 1. 
+//
+// PARAMS: 
+// r - the compressed bitset to check
+//
+// RET: 
+// The number of bits that is set to 1. 
+size_t bitset_roaring_true_len(const bitset_roaring *r) {
+    if (r == NULL)
+        return 0;
+
+    size_t ret = 0;
+    for (size_t i = 0; i < r->n; i++)
+        ret += r->cs[i].card;
+    return ret;
+}
+
+// Determines whether any bit in the compressed bitset is set to 1. 
+//
+// PARAMS: 
+// r - the compressed bitset to test
+//
+// RET: 
+// True or false depending on whether any bit is set to 1. 
+_Bool bitset_roaring_any(const bitset_roaring *r) {
+    return r != NULL && r->n > 0;
+}
+
+// Performs AND operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. The left operand is unchanged on 
+// error. 
+int bitset_roaring_and(bitset_roaring *lhs, const bitset_roaring *rhs) {
+    return roaring_op(OP_AND, lhs, rhs);
+}
+
+// Performs OR operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. The left operand is unchanged on 
+// error. 
+int bitset_roaring_or(bitset_roaring *lhs, const bitset_roaring *rhs) {
+    return roaring_op(OP_OR, lhs, rhs);
+}
+
+// Performs XOR operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. The left operand is unchanged on 
+// error. 
+int bitset_roaring_xor(bitset_roaring *lhs, const bitset_roaring *rhs) {
+    return roaring_op(OP_XOR, lhs, rhs);
+}
+
+// Performs AND NOT operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand, used inverted
+//
+// RET: 
+// Zero on success, non-zero on error. The left operand is unchanged on 
+// error. 
+int bitset_roaring_andnot(bitset_roaring *lhs, const bitset_roaring *rhs) {
+    return roaring_op(OP_ANDNOT, lhs, rhs);
+}
+
+// Converts every chunk to whichever of an array, a bitmap or a list of runs 
+// takes the least memory. 
+//
+// PARAMS: 
+// r - the compressed bitset to optimise
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_optimize(bitset_roaring *r) {
+    if (r == NULL)
+        return BITSET_NULL_ERR;
+
+    int ret = BITSET_GOOD;
+    for (size_t i = 0; i < r->n && ret == BITSET_GOOD; i++) {
+        container *c = &r->cs[i];
+        uint32_t nruns = c_runs(c);
+        size_t run_size = nruns * sizeof(run);
+        size_t other = (c->card <= ARRAY_MAX)
+            ? c->card * sizeof(uint16_t) : CHUNK_WORDS * sizeof(uint64_t);
+        if (run_size < other && c->type != TYPE_RUN)
+            ret = c_runify(c, nruns);
+        else if (run_size >= other && c->type == TYPE_RUN)
+            ret = c_unrun(c);
+    }
+    return ret;
+}
+
+// Frees the internal storage of the given compressed bitset. 
+//
+// PARAMS: 
+// r - the compressed bitset to free
+void bitset_roaring_free(bitset_roaring *r) {
+    if (r != NULL) {
+        for (size_t i = 0; i < r->n; i++)
+            c_free(&r->cs[i]);
+        free(r->cs);
+        r->cs = NULL;
+        r->n = 0;
+        r->cap = 0;
+    }
+}
+
+// Makes sure a container has room for a number of values or runs. 
+//
+// PARAMS: 
+// c - the container to grow
+// n - the number of values or runs needed
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int c_reserve(container *c, uint32_t n) {
+    if (n <= c->cap)
+        return BITSET_GOOD;
+
+    uint32_t cap = (c->cap * 2 > n) ? c->cap * 2 : n;
+    size_t size = (c->type == TYPE_RUN) ? sizeof(run) : sizeof(uint16_t);
+    if (c->type == TYPE_ARRAY && cap > ARRAY_MAX)
+        cap = ARRAY_MAX;
+    void *data = realloc(c->data, cap * size);
+    if (data == NULL)
+        return BITSET_ALLOC_ERR;
+    c->data = data;
+    c->cap = cap;
+    return BITSET_GOOD;
+}
+
+// Initialises a container from the words of a chunk, as an array if it has 
+// few enough bits set to 1 and as a bitmap otherwise. 
+//
+// PARAMS: 
+// c   - the container to initialise
+// key - the index of the chunk
+// w   - the words of the chunk
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int c_from_words(container *c, uint32_t key, const uint64_t *w) {
+    c->key = key;
+    c->card = (uint32_t)bitset_kernel->popcount(w, CHUNK_WORDS);
+    c->size = 0;
+    c->cap = 0;
+    c->data = NULL;
+    if (c->card == 0) {
+        c->type = TYPE_ARRAY;
+        return BITSET_GOOD;
+    }
+
+    if (c->card > ARRAY_MAX) {
+        c->type = TYPE_BITMAP;
+        c->data = malloc(CHUNK_WORDS * sizeof(uint64_t));
+        if (c->data == NULL)
+            return BITSET_ALLOC_ERR;
+        memcpy(c->data, w, CHUNK_WORDS * sizeof(uint64_t));
+        return BITSET_GOOD;
+    }
+
+    c->type = TYPE_ARRAY;
+    if (c_reserve(c, c->card) != BITSET_GOOD)
+        return BITSET_ALLOC_ERR;
+    uint16_t *p = ARRAY(c);
+    for (size_t i = 0; i < CHUNK_WORDS; i++)
+        for (uint64_t v = w[i]; v != 0; v &= v - 1)
+            *p++ = (uint16_t)(i * BITSET_WORD_LEN + bitset_ctz64(v));
+    c->size = c->card;
+    return BITSET_GOOD;
+}
+
+// Writes the bits of a container into the words of a chunk. 
+//
+// PARAMS: 
+// c - the container to write
+// w - the words of the chunk
+static void c_to_words(const container *c, uint64_t *w) {
+    if (c->type == TYPE_BITMAP) {
+        memcpy(w, c->data, CHUNK_WORDS * sizeof(uint64_t));
+        return;
+    }
+
+    memset(w, 0, CHUNK_WORDS * sizeof(uint64_t));
+    if (c->type == TYPE_ARRAY) {
+        for (uint32_t i = 0; i < c->size; i++)
+            w[ARRAY(c)[i] / BITSET_WORD_LEN] |=
+                (uint64_t)1 << (ARRAY(c)[i] % BITSET_WORD_LEN);
+    } else {
+        for (uint32_t i = 0; i < c->size; i++)
+            words_set_range(w, RUNS(c)[i].start, RUNS(c)[i].last);
+    }
+}
+
+// Copies a container. 
+//
+// PARAMS: 
+// dst - the container to initialise
+// src - the container to copy
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int c_copy(container *dst, const container *src) {
+    size_t size = (src->type == TYPE_BITMAP)
+        ? CHUNK_WORDS * sizeof(uint64_t)
+        : src->size * ((src->type == TYPE_RUN) ? sizeof(run)
+                : sizeof(uint16_t));
+    *dst = *src;
+    dst->cap = (src->type == TYPE_BITMAP) ? 0 : src->size;
+    dst->data = malloc(size);
+    if (dst->data == NULL)
+        return BITSET_ALLOC_ERR;
+    memcpy(dst->data, src->data, size);
+    return BITSET_GOOD;
+}
+
+// Converts a run container to an array or a bitmap. 
+//
+// PARAMS: 
+// c - the container to convert
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int c_unrun(container *c) {
+    if (c->type != TYPE_RUN)
+        return BITSET_GOOD;
+
+    uint64_t w[CHUNK_WORDS];
+    container tmp;
+    c_to_words(c, w);
+    int ret = c_from_words(&tmp, c->key, w);
+    if (ret == BITSET_GOOD) {
+        c_free(c);
+        *c = tmp;
+    }
+    return ret;
+}
+
+// Converts an array or a bitmap container to a run container. 
+//
+// PARAMS: 
+// c     - the container to convert
+// nruns - the number of runs in the container
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int c_runify(container *c, uint32_t nruns) {
+    uint64_t w[CHUNK_WORDS];
+    c_to_words(c, w);
+    container tmp = { c->key, TYPE_RUN, c->card, nruns, 0, NULL };
+    if (c_reserve(&tmp, nruns) != BITSET_GOOD)
+        return BITSET_ALLOC_ERR;
+
+    run *p = RUNS(&tmp);
+    size_t i = 0;
+    uint64_t v = w[0];
+    for (;;) {
+        while (v == 0 && ++i < CHUNK_WORDS)
+            v = w[i];
+        if (i >= CHUNK_WORDS)
+            break;
+        size_t start = i * BITSET_WORD_LEN + bitset_ctz64(v);
+        v |= v - 1;                 // fill the bits below the run
+        while (v == UINT64_MAX && ++i < CHUNK_WORDS)
+            v = w[i];
+        size_t end = (i >= CHUNK_WORDS) ? CHUNK_LEN
+            : i * BITSET_WORD_LEN + bitset_ctz64(~v);
+        p->start = (uint16_t)start;
+        p->last = (uint16_t)(end - 1);
+        p++;
+        if (i >= CHUNK_WORDS)
+            break;
+        v &= v + 1;                 // clear the bits up to the run end
+    }
+    c_free(c);
+    *c = tmp;
+    return BITSET_GOOD;
+}
+
+// Counts the runs of consecutive bits set to 1 in a container. 
+//
+// PARAMS: 
+// c - the container to count
+//
+// RET: 
+// The number of runs. 
+static uint32_t c_runs(const container *c) {
+    if (c->type == TYPE_RUN)
+        return c->size;
+
+    uint32_t ret = 0;
+    if (c->type == TYPE_ARRAY) {
+        for (uint32_t i = 0; i < c->size; i++)
+            ret += (i == 0 || ARRAY(c)[i] != ARRAY(c)[i - 1] + 1);
+    } else {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < CHUNK_WORDS; i++) {
+            uint64_t w = BITMAP(c)[i];
+            ret += (uint32_t)bitset_popcount64(w & ~((w << 1) | carry));
+            carry = w >> (BITSET_WORD_LEN - 1);
+        }
+    }
+    return ret;
+}
+
+// Determines whether a value is in a container. 
+//
+// PARAMS: 
+// c - the container to test
+// v - the value to test
+//
+// RET: 
+// True or false depending on whether the bit of the value is set to 1. 
+static _Bool c_test(const container *c, uint16_t v) {
+    if (c->type == TYPE_BITMAP)
+        return (BITMAP(c)[v / BITSET_WORD_LEN] >> (v % BITSET_WORD_LEN)) & 1;
+
+    size_t lo = 0, hi = c->size;
+    if (c->type == TYPE_ARRAY) {
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (ARRAY(c)[mid] < v)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo < c->size && ARRAY(c)[lo] == v;
+    }
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (RUNS(c)[mid].last < v)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < c->size && RUNS(c)[lo].start <= v;
+}
+
+// Adds a value to a container, converting a full array to a bitmap. 
+//
+// PARAMS: 
+// c - the container to change
+// v - the value to add
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int c_add(container *c, uint16_t v) {
+    if (c_test(c, v))
+        return BITSET_GOOD;
+
+    int ret = c_unrun(c);
+    if (ret == BITSET_GOOD && c->type == TYPE_ARRAY && c->card == ARRAY_MAX) {
+        uint64_t w[CHUNK_WORDS];
+        container tmp;
+        c_to_words(c, w);
+        w[v / BITSET_WORD_LEN] |= (uint64_t)1 << (v % BITSET_WORD_LEN);
+        ret = c_from_words(&tmp, c->key, w);
+        if (ret == BITSET_GOOD) {
+            c_free(c);
+            *c = tmp;
+        }
+        return ret;
+    }
+
+    if (ret == BITSET_GOOD && c->type == TYPE_ARRAY) {
+        ret = c_reserve(c, c->size + 1);
+        if (ret == BITSET_GOOD) {
+            uint16_t *a = ARRAY(c);
+            uint32_t i = c->size;
+            while (i > 0 && a[i - 1] > v)
+                i--;
+            memmove(a + i + 1, a + i, (c->size - i) * sizeof *a);
+            a[i] = v;
+            c->size++;
+            c->card++;
+        }
+    } else if (ret == BITSET_GOOD) {
+        BITMAP(c)[v / BITSET_WORD_LEN] |= (uint64_t)1 << (v % BITSET_WORD_LEN);
+        c->card++;
+    }
+    return ret;
+}
+
+// Removes a value from a container, converting a sparse bitmap to an array. 
+//
+// PARAMS: 
+// c - the container to change
+// v - the value to remove
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int c_remove(container *c, uint16_t v) {
+    if (!c_test(c, v))
+        return BITSET_GOOD;
+
+    int ret = c_unrun(c);
+    if (ret == BITSET_GOOD && c->type == TYPE_ARRAY) {
+        uint16_t *a = ARRAY(c);
+        uint32_t i = 0;
+        while (a[i] != v)
+            i++;
+        memmove(a + i, a + i + 1, (c->size - i - 1) * sizeof *a);
+        c->size--;
+        c->card--;
+    } else if (ret == BITSET_GOOD) {
+        BITMAP(c)[v / BITSET_WORD_LEN] &=
+            ~((uint64_t)1 << (v % BITSET_WORD_LEN));
+        if (--c->card == ARRAY_MAX) {
+            container tmp;
+            ret = c_from_words(&tmp, c->key, BITMAP(c));
+            if (ret == BITSET_GOOD) {
+                c_free(c);
+                *c = tmp;
+            }
+        }
+    }
+    return ret;
+}
+
+// Performs a binary operation on two containers of the same chunk, picking 
+// a kernel for the pair of container types. 
+//
+// PARAMS: 
+// op  - the operation
+// a   - the left operand
+// b   - the right operand
+// out - the container to initialise with the result
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int c_op(int op, const container *a, const container *b,
+        container *out) {
+    if (a->type == TYPE_ARRAY && b->type == TYPE_ARRAY)
+        return array_op(op, a, b, out);
+    if (op == OP_AND && a->type == TYPE_ARRAY)
+        return array_filter(a, b, true, out);
+    if (op == OP_AND && b->type == TYPE_ARRAY)
+        return array_filter(b, a, true, out);
+    if (op == OP_ANDNOT && a->type == TYPE_ARRAY)
+        return array_filter(a, b, false, out);
+    if (a->type == TYPE_RUN && b->type == TYPE_RUN
+            && (op == OP_AND || op == OP_OR))
+        return run_op(op, a, b, out);
+
+    uint64_t wa[CHUNK_WORDS], wb[CHUNK_WORDS];
+    const uint64_t *pa = wa, *pb = wb;
+    if (a->type == TYPE_BITMAP)
+        pa = BITMAP(a);
+    else
+        c_to_words(a, wa);
+    if (b->type == TYPE_BITMAP)
+        pb = BITMAP(b);
+    else
+        c_to_words(b, wb);
+
+    if (op == OP_AND)
+        bitset_kernel->and_words(wa, pa, pb, CHUNK_WORDS);
+    else if (op == OP_OR)
+        bitset_kernel->or_words(wa, pa, pb, CHUNK_WORDS);
+    else if (op == OP_XOR)
+        bitset_kernel->xor_words(wa, pa, pb, CHUNK_WORDS);
+    else
+        bitset_kernel->andnot_words(wa, pa, pb, CHUNK_WORDS);
+    return c_from_words(out, a->key, wa);
+}
+
+// Performs a binary operation on two array containers by merging them. 
+//
+// PARAMS: 
+// op  - the operation
+// a   - the left operand
+// b   - the right operand
+// out - the container to initialise with the result
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int array_op(int op, const container *a, const container *b,
+        container *out) {
+    uint16_t buf[2 * ARRAY_MAX];
+    const uint16_t *x = ARRAY(a), *y = ARRAY(b);
+    uint32_t i = 0, j = 0, n = 0;
+    while (i < a->size && j < b->size) {
+        if (x[i] < y[j]) {
+            if (op != OP_AND)
+                buf[n++] = x[i];
+            i++;
+        } else if (x[i] > y[j]) {
+            if (op == OP_OR || op == OP_XOR)
+                buf[n++] = y[j];
+            j++;
+        } else {
+            if (op == OP_AND || op == OP_OR)
+                buf[n++] = x[i];
+            i++;
+            j++;
+        }
+    }
+    for (; i < a->size && op != OP_AND; i++)
+        buf[n++] = x[i];
+    for (; j < b->size && (op == OP_OR || op == OP_XOR); j++)
+        buf[n++] = y[j];
+
+    container tmp = { a->key, TYPE_ARRAY, n, n, 0, NULL };
+    if (n > ARRAY_MAX) {
+        uint64_t w[CHUNK_WORDS];
+        c_to_words(&(container){ a->key, TYPE_ARRAY, n, n, n, buf }, w);
+        return c_from_words(out, a->key, w);
+    }
+    if (n > 0 && c_reserve(&tmp, n) != BITSET_GOOD)
+        return BITSET_ALLOC_ERR;
+    if (n > 0)
+        memcpy(tmp.data, buf, n * sizeof *buf);
+    *out = tmp;
+    return BITSET_GOOD;
+}
+
+// Keeps the values of an array container that are, or are not, in another 
+// container. 
+//
+// PARAMS: 
+// a    - the array container to filter
+// b    - the container to test against
+// keep - true to keep values in b, false to keep values not in b
+// out  - the container to initialise with the result
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int array_filter(const container *a, const container *b,
+        _Bool keep, container *out) {
+    container tmp = { a->key, TYPE_ARRAY, 0, 0, 0, NULL };
+    if (c_reserve(&tmp, a->size) != BITSET_GOOD)
+        return BITSET_ALLOC_ERR;
+
+    uint16_t *p = ARRAY(&tmp);
+    for (uint32_t i = 0; i < a->size; i++)
+        if (c_test(b, ARRAY(a)[i]) == keep)
+            p[tmp.size++] = ARRAY(a)[i];
+    tmp.card = tmp.size;
+    *out = tmp;
+    return BITSET_GOOD;
+}
+
+// Performs AND or OR operation on two run containers by merging their runs. 
+//
+// PARAMS: 
+// op  - the operation, OP_AND or OP_OR
+// a   - the left operand
+// b   - the right operand
+// out - the container to initialise with the result
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int run_op(int op, const container *a, const container *b,
+        container *out) {
+    container tmp = { a->key, TYPE_RUN, 0, 0, 0, NULL };
+    if (c_reserve(&tmp, a->size + b->size) != BITSET_GOOD)
+        return BITSET_ALLOC_ERR;
+
+    const run *x = RUNS(a), *y = RUNS(b);
+    run *p = RUNS(&tmp);
+    uint32_t i = 0, j = 0;
+    if (op == OP_AND) {
+        while (i < a->size && j < b->size) {
+            uint16_t lo = (x[i].start > y[j].start) ? x[i].start : y[j].start;
+            uint16_t hi = (x[i].last < y[j].last) ? x[i].last : y[j].last;
+            if (lo <= hi) {
+                p[tmp.size].start = lo;
+                p[tmp.size++].last = hi;
+                tmp.card += (uint32_t)(hi - lo) + 1;
+            }
+            if (x[i].last < y[j].last)
+                i++;
+            else
+                j++;
+        }
+    } else {
+        while (i < a->size || j < b->size) {
+            const run *next = (j >= b->size
+                    || (i < a->size && x[i].start <= y[j].start))
+                ? &x[i++] : &y[j++];
+            run *prev = &p[tmp.size - (tmp.size > 0)];
+            if (tmp.size > 0 && next->start <= (uint32_t)prev->last + 1) {
+                if (next->last > prev->last)
+                    prev->last = next->last;
+            } else {
+                p[tmp.size++] = *next;
+            }
+        }
+        for (uint32_t k = 0; k < tmp.size; k++)
+            tmp.card += (uint32_t)(p[k].last - p[k].start) + 1;
+    }
+    *out = tmp;
+    return BITSET_GOOD;
+}
+
+// Frees the storage of a container. 
+//
+// PARAMS: 
+// c - the container to free
+static void c_free(container *c) {
+    free(c->data);
+    c->data = NULL;
+    c->size = 0;
+    c->cap = 0;
+}
+
+// Changes an inclusive range of bits to 1. 
+//
+// PARAMS: 
+// w  - the words to change
+// lo - the first bit of the range
+// hi - the last bit of the range
+static void words_set_range(uint64_t *w, size_t lo, size_t hi) {
+    size_t i = lo / BITSET_WORD_LEN, j = hi / BITSET_WORD_LEN;
+    uint64_t head = UINT64_MAX << (lo % BITSET_WORD_LEN);
+    uint64_t tail = UINT64_MAX >> (BITSET_WORD_LEN - 1 - hi % BITSET_WORD_LEN);
+    if (i == j) {
+        w[i] |= head & tail;
+    } else {
+        w[i] |= head;
+        for (size_t k = i + 1; k < j; k++)
+            w[k] = UINT64_MAX;
+        w[j] |= tail;
+    }
+}
+
+// Finds the container of a chunk, or where it would be inserted. 
+//
+// PARAMS: 
+// r   - the compressed bitset to search
+// key - the index of the chunk
+//
+// RET: 
+// The position of the first container with a key not less than key. 
+static size_t find(const bitset_roaring *r, uint32_t key) {
+    size_t lo = 0, hi = r->n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (r->cs[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Inserts an empty array container. 
+//
+// PARAMS: 
+// r   - the compressed bitset to change
+// pos - the position to insert at
+// key - the index of the chunk
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int insert(bitset_roaring *r, size_t pos, uint32_t key) {
+    if (r->n == r->cap) {
+        size_t cap = (r->cap == 0) ? 4 : r->cap * 2;
+        container *cs = realloc(r->cs, cap * sizeof *cs);
+        if (cs == NULL)
+            return BITSET_ALLOC_ERR;
+        r->cs = cs;
+        r->cap = cap;
+    }
+    memmove(r->cs + pos + 1, r->cs + pos, (r->n - pos) * sizeof *r->cs);
+    r->cs[pos] = (container){ key, TYPE_ARRAY, 0, 0, 0, NULL };
+    r->n++;
+    return BITSET_GOOD;
+}
+
+// Frees and removes a container. 
+//
+// PARAMS: 
+// r   - the compressed bitset to change
+// pos - the position of the container
+static void erase(bitset_roaring *r, size_t pos) {
+    c_free(&r->cs[pos]);
+    memmove(r->cs + pos, r->cs + pos + 1, (r->n - pos - 1) * sizeof *r->cs);
+    r->n--;
+}
+
+// Performs a binary operation on two compressed bitsets, storing output in 
+// the left operand. Containers only in the left operand are moved rather 
+// than copied. 
+//
+// PARAMS: 
+// op  - the operation
+// lhs - the left operand
+// rhs - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. The left operand is unchanged on 
+// error. 
+static int roaring_op(int op, bitset_roaring *lhs, const bitset_roaring *rhs) {
+    if (lhs == NULL || rhs == NULL)
+        return BITSET_NULL_ERR;
+    if (lhs->n + rhs->n == 0)
+        return BITSET_GOOD;
+
+    size_t cap = lhs->n + rhs->n;
+    container *out = malloc(cap * sizeof *out);
+    _Bool *own = calloc(cap, sizeof *own);     // out[k] is a new container
+    if (out == NULL || own == NULL) {
+        free(out);
+        free(own);
+        return BITSET_ALLOC_ERR;
+    }
+
+    int ret = BITSET_GOOD;
+    size_t i = 0, j = 0, n = 0;
+    while (ret == BITSET_GOOD && (i < lhs->n || j < rhs->n)) {
+        const container *a = (i < lhs->n) ? &lhs->cs[i] : NULL;
+        const container *b = (j < rhs->n) ? &rhs->cs[j] : NULL;
+        if (b == NULL || (a != NULL && a->key < b->key)) {
+            if (op != OP_AND)
+                out[n++] = *a;
+            i++;
+            continue;
+        }
+
+        if (a == NULL || b->key < a->key) {
+            j++;
+            if (op == OP_AND || op == OP_ANDNOT)
+                continue;
+            ret = c_copy(&out[n], b);
+        } else {
+            ret = c_op(op, a, b, &out[n]);
+            i++;
+            j++;
+        }
+        if (ret == BITSET_GOOD && out[n].card == 0)
+            c_free(&out[n]);
+        else if (ret == BITSET_GOOD)
+            own[n++] = true;
+    }
+
+    if (ret != BITSET_GOOD) {
+        for (size_t k = 0; k < n; k++)
+            if (own[k])
+                c_free(&out[k]);
+        free(out);
+    } else {
+        // free the containers of lhs that were combined or dropped
+        for (size_t k = 0, m = 0; k < lhs->n; k++) {
+            while (m < n && out[m].key < lhs->cs[k].key)
+                m++;
+            if (m == n || out[m].key != lhs->cs[k].key || own[m])
+                c_free(&lhs->cs[k]);
+        }
+        free(lhs->cs);
+        lhs->cs = out;
+        lhs->n = n;
+        lhs->cap = cap;
+    }
+    free(own);
+    return ret;
+}
@@ -0,0 +1,180 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_roaring.h
+// Compressed bit set for sparse and run-heavy sets of 32-bit indices. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_ROARING_H
+#define BITSET_ROARING_H
+#include "bitset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The compressed bitset type. Indices are split into chunks of 65536 bits, 
+// and each chunk with a bit set to 1 is stored in the smallest of a sorted 
+// array, a dense bitmap or a list of runs. 
+typedef struct bitset_roaring_t {
+    struct bitset_container_t *cs;  // containers, sorted by chunk
+    size_t n;                       // number of containers
+    size_t cap;                     // number of containers allocated
+} bitset_roaring;
+
+// Initialises the specified compressed bitset, with every bit set to 0. 
+//
+// PARAMS: 
+// r - the compressed bitset to initialise
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_init(bitset_roaring *r);
+
+// Initialises the specified compressed bitset from a bitset. The bitset must 
+// be at most 2^32 bits long. 
+//
+// PARAMS: 
+// r - the compressed bitset to initialise
+// b - the bitset to initialise from
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_init_bitset(bitset_roaring *r, const bitset *b);
+
+// Writes a compressed bitset into an initialised bitset, replacing its bits. 
+//
+// PARAMS: 
+// r - the compressed bitset to write
+// b - the bitset to write into, long enough to hold every bit set to 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_to_bitset(const bitset_roaring *r, bitset *b);
+
+// Changes the specified bit to 1. 
+//
+// PARAMS: 
+// r - the compressed bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_set(bitset_roaring *r, uint32_t i);
+
+// Changes the specified bit to 0. 
+//
+// PARAMS: 
+// r - the compressed bitset to change
+// i - the index of the bit
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_clear(bitset_roaring *r, uint32_t i);
+
+// Determines whether the specified bit is set to 1. 
+//
+// PARAMS: 
+// r - the compressed bitset to test
+// i - the index of the bit
+//
+// RET: 
+// True or false depending on whether the bit is set to 1. 
+_Bool bitset_roaring_test(const bitset_roaring *r, uint32_t i);
+
+// Changes a range of bits to 1. Whole chunks in the range are stored as a 
+// single run. 
+//
+// PARAMS: 
+// r   - the compressed bitset to change
+// pos - the first bit of the range
+// n   - the number of bits in the range, with pos + n at most 2^32
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_set_range(bitset_roaring *r, uint32_t pos, uint64_t n);
+
+// Returns the number of bits set to 1. 
+//
+// PARAMS: 
+// r - the compressed bitset to check
+//
+// RET: 
+// The number of bits that is set to 1. 
+size_t bitset_roaring_true_len(const bitset_roaring *r);
+
+// Determines whether any bit in the compressed bitset is set to 1. 
+//
+// PARAMS: 
+// r - the compressed bitset to test
+//
+// RET: 
+// True or false depending on whether any bit is set to 1. 
+_Bool bitset_roaring_any(const bitset_roaring *r);
+
+// Performs AND operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. The left operand is unchanged on 
+// error. 
+int bitset_roaring_and(bitset_roaring *lhs, const bitset_roaring *rhs);
+
+// Performs OR operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. The left operand is unchanged on 
+// error. 
+int bitset_roaring_or(bitset_roaring *lhs, const bitset_roaring *rhs);
+
+// Performs XOR operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand
+//
+// RET: 
+// Zero on success, non-zero on error. The left operand is unchanged on 
+// error. 
+int bitset_roaring_xor(bitset_roaring *lhs, const bitset_roaring *rhs);
+
+// Performs AND NOT operation, storing output in the left operand. 
+//
+// PARAMS: 
+// lhs - the left operand
+// rhs - the right operand, used inverted
+//
+// RET: 
+// Zero on success, non-zero on error. The left operand is unchanged on 
+// error. 
+int bitset_roaring_andnot(bitset_roaring *lhs, const bitset_roaring *rhs);
+
+// Converts every chunk to whichever of an array, a bitmap or a list of runs 
+// takes the least memory. 
+//
+// PARAMS: 
+// r - the compressed bitset to optimise
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_roaring_optimize(bitset_roaring *r);
+
+// Frees the internal storage of the given compressed bitset. 
+//
+// PARAMS: 
+// r - the compressed bitset to free
+void bitset_roaring_free(bitset_roaring *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_stats.c
+// Opt-in counters and timings of bitset operations. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+#include "bitset_stats.h"
+
+#define BITSET_STATS_NAME(op, name) "bitset_" #name,
+
+// The names of the counted operations. 
+static const char *names[BITSET_OP_COUNT] = {
+    BITSET_STATS_OPS(BITSET_STATS_NAME)
+};
+
+#ifdef BITSET_STATS
+// The counters of a thread, kept in a list of every thread so far. They are 
+// never freed, so the counts of exited threads stay in the totals. 
+typedef struct stats_block_t {
+    bitset_stats s;                 // the counters
+    struct stats_block_t *next;     // the block of the previous thread
+} stats_block;
+
+__thread bitset_stats *bitset_stats_local;
+static stats_block *blocks;         // the block of the latest thread
+
+static void add(bitset_stats *out, const bitset_stats *s);
+#endif
+
+// Returns the name of an operation. 
+//
+// PARAMS: 
+// op - the index of the operation
+//
+// RET: 
+// The name of the function counted, or NULL on error. 
+const char *bitset_stats_name(int op) {
+    return (op >= 0 && op < BITSET_OP_COUNT) ? names[op] : NULL;
+}
+
+// Adds up the counters of every thread that has used a bitset, including 
+// threads that have exited. Counters of running threads may be read in the 
+// middle of a call, so the totals are only exact once they are idle. 
+//
+// PARAMS: 
+// out - the totals to fill
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stats_get(bitset_stats *out) {
+    if (out == NULL)
+        return BITSET_NULL_ERR;
+
+    memset(out, 0, sizeof *out);
+#ifdef BITSET_STATS
+    for (stats_block *p = __atomic_load_n(&blocks, __ATOMIC_ACQUIRE);
+            p != NULL; p = p->next)
+        add(out, &p->s);
+#endif
+    return BITSET_GOOD;
+}
+
+// Changes every counter of every thread to 0. Calls running in other 
+// threads at the same time may be lost or half counted. 
+void bitset_stats_reset(void) {
+#ifdef BITSET_STATS
+    for (stats_block *p = __atomic_load_n(&blocks, __ATOMIC_ACQUIRE);
+            p != NULL; p = p->next)
+        memset(&p->s, 0, sizeof p->s);
+#endif
+}
+
+// Writes the totals of every counted operation that was called, one line 
+// each, followed by the histograms of their ticks if timing is enabled. 
+//
+// PARAMS: 
+// f - the file to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stats_dump(FILE *f) {
+    if (f == NULL)
+        return BITSET_NULL_ERR;
+
+    bitset_stats t;
+    bitset_stats_get(&t);
+    fprintf(f, "bitset stats: %zu threads, %llu allocations of %llu bytes\n",
+            t.threads, (unsigned long long)t.allocs,
+            (unsigned long long)t.alloc_bytes);
+    fprintf(f, "%-28s %14s %18s %14s\n", "function", "calls", "bytes",
+            "ticks/call");
+    for (int op = 0; op < BITSET_OP_COUNT; op++) {
+        if (t.calls[op] == 0)
+            continue;
+        fprintf(f, "%-28s %14llu %18llu %14.1f\n", names[op],
+                (unsigned long long)t.calls[op],
+                (unsigned long long)t.bytes[op],
+                (double)t.ticks[op] / t.calls[op]);
+    }
+    for (int op = 0; op < BITSET_OP_COUNT; op++) {
+        if (t.ticks[op] == 0)
+            continue;
+        fprintf(f, "%s ticks:", names[op]);
+        for (int i = 0; i < BITSET_STATS_BUCKETS; i++)
+            if (t.hist[op][i] != 0)
+                fprintf(f, " 2^%d:%llu", i, (unsigned long long)t.hist[op][i]);
+        fputc('\n', f);
+    }
+    return ferror(f) ? BITSET_IO_ERR : BITSET_GOOD;
+}
+
+#ifdef BITSET_STATS
+// Allocates and registers the counters of the calling thread. 
+//
+// RET: 
+// The counters of the thread, or NULL on error. 
+bitset_stats *bitset_stats_attach(void) {
+    stats_block *p = calloc(1, sizeof *p);
+    if (p == NULL)
+        return NULL;
+
+    p->next = __atomic_load_n(&blocks, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&blocks, &p->next, p, true,
+            __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;   // another thread registered first, p->next now holds it
+    bitset_stats_local = &p->s;
+    return &p->s;
+}
+
+#if defined(BITSET_STATS_TIMING) && !defined(__x86_64__) && !defined(__i386__)
+// Returns the time of a monotonic clock in nanoseconds. 
+uint64_t bitset_stats_ticks(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+#endif
+
+// Adds the counters of one thread to the totals. 
+//
+// PARAMS: 
+// out - the totals to add to
+// s   - the counters to add
+static void add(bitset_stats *out, const bitset_stats *s) {
+    for (int op = 0; op < BITSET_OP_COUNT; op++) {
+        out->calls[op] += s->calls[op];
+        out->bytes[op] += s->bytes[op];
+        out->ticks[op] += s->ticks[op];
+        for (int i = 0; i < BITSET_STATS_BUCKETS; i++)
+            out->hist[op][i] += s->hist[op][i];
+    }
+    out->allocs += s->allocs;
+    out->alloc_bytes += s->alloc_bytes;
+    out->threads++;
+}
+#endif
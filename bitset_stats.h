@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_stats.h
+// Opt-in counters and timings of bitset operations. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_STATS_H
+#define BITSET_STATS_H
+#include <stdio.h>
+#include "bitset.h"
+#if defined(BITSET_STATS_TIMING) && !defined(BITSET_STATS)
+#define BITSET_STATS
+#endif
+#if defined(BITSET_STATS_TIMING) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Counting is compiled in by defining BITSET_STATS, and timing as well by 
+// defining BITSET_STATS_TIMING, when building bitset.c and bitset_stats.c. 
+// Without them the hooks below expand to nothing, and the functions of this 
+// header report every count as 0. 
+
+// Number of histogram buckets. Bucket i counts calls taking 2^i to 
+// 2^(i + 1) - 1 ticks, and the last bucket also counts longer calls. 
+#define BITSET_STATS_BUCKETS 32
+
+// The operations counted. Functions that only forward to another count as 
+// that one: bitset_init, bitset_init_bstr and bitset_init_str as their 
+// _alloc variants, bitset_init_inline as bitset_init_buffer, bitset_andnot 
+// as bitset_andnot3 and bitset_swap as three bitset_move calls. 
+#define BITSET_STATS_OPS(X) \
+    X(INIT_ALLOC, init_alloc) X(INIT_BUFFER, init_buffer) \
+    X(INIT_BSTR_ALLOC, init_bstr_alloc) X(INIT_STR_ALLOC, init_str_alloc) \
+    X(COPY, copy) X(MOVE, move) X(TO_BSTR, to_bstr) \
+    X(RESERVE, reserve) X(RESIZE, resize) X(PUSH_BACK, push_back) \
+    X(APPEND, append) X(SET_CHECKED, set_checked) \
+    X(CLEAR_CHECKED, clear_checked) X(FLIP_CHECKED, flip_checked) \
+    X(TEST_CHECKED, test_checked) X(SET_MANY, set_many) \
+    X(CLEAR_MANY, clear_many) X(FLIP_MANY, flip_many) \
+    X(SET_RANGE, set_range) X(CLEAR_RANGE, clear_range) \
+    X(FLIP_RANGE, flip_range) X(COUNT_RANGE, count_range) \
+    X(ANY_RANGE, any_range) X(NEXT_SET, next_set) \
+    X(NEXT_CLEAR, next_clear) X(PREV_SET, prev_set) X(FOREACH, foreach) \
+    X(TO_INDICES, to_indices) X(TRUE_LEN, true_len) X(ALL, all) \
+    X(ANY, any) X(INTERSECTS, intersects) X(IS_SUBSET, is_subset) \
+    X(AND, and) X(OR, or) X(XOR, xor) X(AND3, and3) X(OR3, or3) \
+    X(XOR3, xor3) X(ANDNOT3, andnot3) X(AND_MANY, and_many) \
+    X(OR_MANY, or_many) X(XOR_MANY, xor_many) \
+    X(THRESHOLD_MANY, threshold_many) X(AND_COUNT, and_count) \
+    X(OR_COUNT, or_count) X(XOR_COUNT, xor_count) \
+    X(ANDNOT_COUNT, andnot_count) X(NOT, not) X(LSH, lsh) X(RSH, rsh) \
+    X(LROT, lrot) X(RROT, rrot) X(RESET, reset) X(FREE, free)
+
+#define BITSET_STATS_ENUM(op, name) BITSET_OP_##op,
+
+// The indices of the counted operations, BITSET_OP_AND and so on. 
+enum {
+    BITSET_STATS_OPS(BITSET_STATS_ENUM)
+    BITSET_OP_COUNT
+};
+
+// The counters of one thread, or their totals across threads. Bytes are the 
+// words of the operands a call reads or writes, taken from their lengths 
+// before it runs. Ticks are cycles on x86 and nanoseconds elsewhere, and 
+// stay at 0 unless BITSET_STATS_TIMING is defined. 
+typedef struct bitset_stats_t {
+    uint64_t calls[BITSET_OP_COUNT];    // calls of each operation
+    uint64_t bytes[BITSET_OP_COUNT];    // bytes touched by each operation
+    uint64_t ticks[BITSET_OP_COUNT];    // ticks spent in each operation
+    uint64_t hist[BITSET_OP_COUNT][BITSET_STATS_BUCKETS];   // ticks per call
+    uint64_t allocs;        // allocations of bits
+    uint64_t alloc_bytes;   // bytes of bits allocated
+    size_t threads;         // threads counted in the totals
+} bitset_stats;
+
+// Returns the name of an operation. 
+//
+// PARAMS: 
+// op - the index of the operation
+//
+// RET: 
+// The name of the function counted, or NULL on error. 
+const char *bitset_stats_name(int op);
+
+// Adds up the counters of every thread that has used a bitset, including 
+// threads that have exited. Counters of running threads may be read in the 
+// middle of a call, so the totals are only exact once they are idle. 
+//
+// PARAMS: 
+// out - the totals to fill
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stats_get(bitset_stats *out);
+
+// Changes every counter of every thread to 0. Calls running in other 
+// threads at the same time may be lost or half counted. 
+void bitset_stats_reset(void);
+
+// Writes the totals of every counted operation that was called, one line 
+// each, followed by the histograms of their ticks if timing is enabled. 
+//
+// PARAMS: 
+// f - the file to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stats_dump(FILE *f);
+
+#ifdef BITSET_STATS
+#ifndef __GNUC__
+#error "BITSET_STATS needs the GCC/Clang __thread and cleanup attributes"
+#endif
+
+// The counters of the calling thread, NULL until its first counted call. 
+extern __thread bitset_stats *bitset_stats_local;
+
+// Allocates and registers the counters of the calling thread. 
+//
+// RET: 
+// The counters of the thread, or NULL on error. 
+bitset_stats *bitset_stats_attach(void);
+
+// Returns the counters of the calling thread. 
+//
+// RET: 
+// The counters of the thread, or NULL if they could not be allocated. 
+static inline bitset_stats *bitset_stats_self(void) {
+    bitset_stats *s = bitset_stats_local;
+    return (s != NULL) ? s : bitset_stats_attach();
+}
+
+// Counts a call of an operation. 
+//
+// PARAMS: 
+// op    - the index of the operation
+// bytes - the bytes the call touches
+static inline void bitset_stats_count(int op, size_t bytes) {
+    bitset_stats *s = bitset_stats_self();
+    if (s != NULL) {
+        s->calls[op]++;
+        s->bytes[op] += bytes;
+    }
+}
+
+// Counts an allocation of bits. 
+//
+// PARAMS: 
+// bytes - the size of the allocation
+static inline void bitset_stats_alloc(size_t bytes) {
+    bitset_stats *s = bitset_stats_self();
+    if (s != NULL) {
+        s->allocs++;
+        s->alloc_bytes += bytes;
+    }
+}
+
+#ifdef BITSET_STATS_TIMING
+#if defined(__x86_64__) || defined(__i386__)
+// Returns the time stamp counter. 
+static inline uint64_t bitset_stats_ticks(void) {
+    return __rdtsc();
+}
+#else
+// Returns the time of a monotonic clock in nanoseconds. 
+uint64_t bitset_stats_ticks(void);
+#endif
+
+// The start of a timed call. 
+typedef struct bitset_stats_timer_t {
+    int op;             // the index of the operation
+    uint64_t start;     // the ticks when the call started
+} bitset_stats_timer;
+
+// Counts a call of an operation and starts timing it. 
+//
+// PARAMS: 
+// op    - the index of the operation
+// bytes - the bytes the call touches
+//
+// RET: 
+// The timer to stop when the call returns. 
+static inline bitset_stats_timer bitset_stats_start(int op, size_t bytes) {
+    bitset_stats_timer t;
+    bitset_stats_count(op, bytes);
+    t.op = op;
+    t.start = bitset_stats_ticks();
+    return t;
+}
+
+// Stops timing a call, adding its ticks to its operation and histogram. 
+//
+// PARAMS: 
+// t - the timer of the call
+static inline void bitset_stats_stop(const bitset_stats_timer *t) {
+    uint64_t d = bitset_stats_ticks() - t->start;
+    bitset_stats *s = bitset_stats_local;
+    if (s != NULL) {
+        unsigned i = 63 - bitset_clz64(d | 1);
+        s->ticks[t->op] += d;
+        s->hist[t->op][(i < BITSET_STATS_BUCKETS) ? i
+            : BITSET_STATS_BUCKETS - 1]++;
+    }
+}
+
+// Counts and times the rest of the enclosing function, stopping the timer 
+// on every return. 
+#define BITSET_STAT(op, bytes) \
+    bitset_stats_timer bitset_stats_timer_ \
+        __attribute__((cleanup(bitset_stats_stop))) = \
+        bitset_stats_start(BITSET_OP_##op, (bytes))
+#else
+#define BITSET_STAT(op, bytes) bitset_stats_count(BITSET_OP_##op, (bytes))
+#endif
+#define BITSET_STAT_ALLOC(bytes) bitset_stats_alloc(bytes)
+#else
+#define BITSET_STAT(op, bytes) ((void)0)
+#define BITSET_STAT_ALLOC(bytes) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
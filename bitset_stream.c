@@ -0,0 +1,309 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_stream.c
+// Chunked operations on bitsets streamed from files or callbacks. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define BITSET_FD
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "bitset_stream.h"
+#include "bitset_kernel.h"
+#define CHUNK BITSET_STREAM_WORDS
+
+// The binary kernel type. 
+typedef void (*binary_fn)(uint64_t *dst, const uint64_t *a,
+        const uint64_t *b, size_t n);
+
+static size_t read_chunk(bitset_source *src, uint64_t *w);
+static void prefetch_chunk(bitset_source *src);
+static int stream_op(binary_fn fn, bitset_source *a, bitset_source *b,
+        bitset_sink *out);
+#ifdef BITSET_FD
+static size_t fd_read(uint64_t *words, size_t n, void *ctx);
+static void fd_prefetch(size_t n, void *ctx);
+static int fd_write(const uint64_t *words, size_t n, void *ctx);
+#endif
+
+#ifdef BITSET_FD
+// Initialises a source reading words from a file descriptor, starting at 
+// its current offset. Use lseek to skip the header of a saved file. 
+//
+// PARAMS: 
+// src - the source to initialise
+// fd  - the file descriptor to read from
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_source_fd(bitset_source *src, int fd) {
+    if (src == NULL)
+        return BITSET_NULL_ERR;
+    if (fd < 0)
+        return BITSET_IO_ERR;
+
+    src->read = fd_read;
+    src->prefetch = fd_prefetch;
+    src->ctx = (void *)(intptr_t)fd;
+    return BITSET_GOOD;
+}
+
+// Initialises a sink writing words to a file descriptor. 
+//
+// PARAMS: 
+// dst - the sink to initialise
+// fd  - the file descriptor to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_sink_fd(bitset_sink *dst, int fd) {
+    if (dst == NULL)
+        return BITSET_NULL_ERR;
+    if (fd < 0)
+        return BITSET_IO_ERR;
+
+    dst->write = fd_write;
+    dst->ctx = (void *)(intptr_t)fd;
+    return BITSET_GOOD;
+}
+#endif
+
+// Performs AND operation on two sources chunk by chunk, writing output to 
+// a sink. The sources must hold the same number of words. 
+//
+// PARAMS: 
+// a   - the left operand
+// b   - the right operand
+// out - the sink to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stream_and(bitset_source *a, bitset_source *b, bitset_sink *out) {
+    return stream_op(bitset_kernel->and_words, a, b, out);
+}
+
+// Performs OR operation on two sources chunk by chunk, writing output to a 
+// sink. The sources must hold the same number of words. 
+//
+// PARAMS: 
+// a   - the left operand
+// b   - the right operand
+// out - the sink to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stream_or(bitset_source *a, bitset_source *b, bitset_sink *out) {
+    return stream_op(bitset_kernel->or_words, a, b, out);
+}
+
+// Performs XOR operation on two sources chunk by chunk, writing output to 
+// a sink. The sources must hold the same number of words. 
+//
+// PARAMS: 
+// a   - the left operand
+// b   - the right operand
+// out - the sink to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stream_xor(bitset_source *a, bitset_source *b, bitset_sink *out) {
+    return stream_op(bitset_kernel->xor_words, a, b, out);
+}
+
+// Performs AND NOT operation on two sources chunk by chunk, writing output 
+// to a sink. The sources must hold the same number of words. 
+//
+// PARAMS: 
+// a   - the left operand
+// b   - the right operand, used inverted
+// out - the sink to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stream_andnot(bitset_source *a, bitset_source *b,
+        bitset_sink *out) {
+    return stream_op(bitset_kernel->andnot_words, a, b, out);
+}
+
+// Counts the bits set to 1 in a source chunk by chunk. 
+//
+// PARAMS: 
+// src   - the source to count
+// count - the output number of bits set to 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stream_count(bitset_source *src, uint64_t *count) {
+    if (src == NULL || src->read == NULL || count == NULL)
+        return BITSET_NULL_ERR;
+
+    uint64_t *w = malloc(CHUNK * sizeof(uint64_t));
+    if (w == NULL)
+        return BITSET_ALLOC_ERR;
+
+    int ret = BITSET_GOOD;
+    uint64_t total = 0;
+    for (;;) {
+        size_t n = read_chunk(src, w);
+        if (n == BITSET_NPOS)
+            ret = BITSET_IO_ERR;
+        if (n == 0 || n == BITSET_NPOS)
+            break;
+        prefetch_chunk(src);
+        total += bitset_kernel->popcount(w, n);
+    }
+    free(w);
+    if (ret == BITSET_GOOD)
+        *count = total;
+    return ret;
+}
+
+// Reads a whole chunk from a source, unless the source ends first. 
+//
+// PARAMS: 
+// src - the source to read from
+// w   - the chunk to read into
+//
+// RET: 
+// The number of words read, or BITSET_NPOS on error. 
+static size_t read_chunk(bitset_source *src, uint64_t *w) {
+    size_t n = 0;
+    while (n < CHUNK) {
+        size_t k = src->read(w + n, CHUNK - n, src->ctx);
+        if (k == BITSET_NPOS || k > CHUNK - n)
+            return BITSET_NPOS;
+        if (k == 0)
+            break;
+        n += k;
+    }
+    return n;
+}
+
+// Hints a source that the next chunk will be read, so that it can load it 
+// while the current chunk is processed. 
+//
+// PARAMS: 
+// src - the source to hint
+static void prefetch_chunk(bitset_source *src) {
+    if (src->prefetch != NULL)
+        src->prefetch(CHUNK, src->ctx);
+}
+
+// Performs a binary operation on two sources chunk by chunk, writing output 
+// to a sink. 
+//
+// PARAMS: 
+// fn  - the binary kernel
+// a   - the left operand
+// b   - the right operand
+// out - the sink to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int stream_op(binary_fn fn, bitset_source *a, bitset_source *b,
+        bitset_sink *out) {
+    if (a == NULL || b == NULL || out == NULL || a->read == NULL
+            || b->read == NULL || out->write == NULL)
+        return BITSET_NULL_ERR;
+
+    uint64_t *wa = malloc(2 * CHUNK * sizeof(uint64_t));
+    if (wa == NULL)
+        return BITSET_ALLOC_ERR;
+
+    uint64_t *wb = wa + CHUNK;
+    int ret = BITSET_GOOD;
+    while (ret == BITSET_GOOD) {
+        size_t na = read_chunk(a, wa);
+        size_t nb = read_chunk(b, wb);
+        if (na == BITSET_NPOS || nb == BITSET_NPOS)
+            ret = BITSET_IO_ERR;
+        else if (na != nb)
+            ret = BITSET_LENGTH_ERR;
+        if (ret != BITSET_GOOD || na == 0)
+            break;
+
+        prefetch_chunk(a);
+        prefetch_chunk(b);
+        fn(wa, wa, wb, na);
+        if (out->write(wa, na, out->ctx) != 0)
+            ret = BITSET_IO_ERR;
+    }
+    free(wa);
+    return ret;
+}
+
+#ifdef BITSET_FD
+// Reads words from a file descriptor. 
+//
+// PARAMS: 
+// words - the words to read into
+// n     - the number of words to read
+// ctx   - the file descriptor
+//
+// RET: 
+// The number of words read, 0 at the end or BITSET_NPOS on error. 
+static size_t fd_read(uint64_t *words, size_t n, void *ctx) {
+    int fd = (int)(intptr_t)ctx;
+    char *p = (char *)words;
+    size_t size = n * sizeof(uint64_t), done = 0;
+    while (done < size) {
+        ssize_t k = read(fd, p + done, size - done);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k < 0)
+            return BITSET_NPOS;
+        if (k == 0)
+            break;
+        done += (size_t)k;
+    }
+    return (done % sizeof(uint64_t) == 0) ? done / sizeof(uint64_t)
+        : BITSET_NPOS;
+}
+
+// Asks the kernel to read ahead the next words of a file descriptor. 
+//
+// PARAMS: 
+// n   - the number of words to read ahead
+// ctx - the file descriptor
+static void fd_prefetch(size_t n, void *ctx) {
+#ifdef POSIX_FADV_WILLNEED
+    int fd = (int)(intptr_t)ctx;
+    off_t at = lseek(fd, 0, SEEK_CUR);
+    if (at >= 0)
+        posix_fadvise(fd, at, (off_t)(n * sizeof(uint64_t)),
+                POSIX_FADV_WILLNEED);
+#else
+    (void)n;
+    (void)ctx;
+#endif
+}
+
+// Writes words to a file descriptor. 
+//
+// PARAMS: 
+// words - the words to write
+// n     - the number of words to write
+// ctx   - the file descriptor
+//
+// RET: 
+// Zero on success, non-zero on error. 
+static int fd_write(const uint64_t *words, size_t n, void *ctx) {
+    int fd = (int)(intptr_t)ctx;
+    const char *p = (const char *)words;
+    size_t size = n * sizeof(uint64_t), done = 0;
+    while (done < size) {
+        ssize_t k = write(fd, p + done, size - done);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k <= 0)
+            return BITSET_IO_ERR;
+        done += (size_t)k;
+    }
+    return BITSET_GOOD;
+}
+#endif
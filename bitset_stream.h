@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitset_stream.h
+// Chunked operations on bitsets streamed from files or callbacks. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BITSET_STREAM_H
+#define BITSET_STREAM_H
+#include "bitset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of words processed per chunk. Each operation holds two chunks of 
+// this size in memory, whatever the length of its operands. 
+#define BITSET_STREAM_WORDS 65536
+
+// The word source type. 
+typedef struct bitset_source_t {
+    // reads up to n words, returning the number read, 0 at the end or 
+    // BITSET_NPOS on error
+    size_t (*read)(uint64_t *words, size_t n, void *ctx);
+
+    // hints that the next n words will be read soon, may be NULL
+    void (*prefetch)(size_t n, void *ctx);
+    void *ctx;              // passed to the callbacks
+} bitset_source;
+
+// The word sink type. 
+typedef struct bitset_sink_t {
+    // writes n words, returning zero on success and non-zero on error
+    int (*write)(const uint64_t *words, size_t n, void *ctx);
+    void *ctx;              // passed to the callback
+} bitset_sink;
+
+#if defined(__unix__) || defined(__APPLE__)
+// Initialises a source reading words from a file descriptor, starting at 
+// its current offset. Use lseek to skip the header of a saved file. 
+//
+// PARAMS: 
+// src - the source to initialise
+// fd  - the file descriptor to read from
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_source_fd(bitset_source *src, int fd);
+
+// Initialises a sink writing words to a file descriptor. 
+//
+// PARAMS: 
+// dst - the sink to initialise
+// fd  - the file descriptor to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_sink_fd(bitset_sink *dst, int fd);
+#endif
+
+// Performs AND operation on two sources chunk by chunk, writing output to 
+// a sink. The sources must hold the same number of words. 
+//
+// PARAMS: 
+// a   - the left operand
+// b   - the right operand
+// out - the sink to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stream_and(bitset_source *a, bitset_source *b, bitset_sink *out);
+
+// Performs OR operation on two sources chunk by chunk, writing output to a 
+// sink. The sources must hold the same number of words. 
+//
+// PARAMS: 
+// a   - the left operand
+// b   - the right operand
+// out - the sink to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stream_or(bitset_source *a, bitset_source *b, bitset_sink *out);
+
+// Performs XOR operation on two sources chunk by chunk, writing output to 
+// a sink. The sources must hold the same number of words. 
+//
+// PARAMS: 
+// a   - the left operand
+// b   - the right operand
+// out - the sink to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stream_xor(bitset_source *a, bitset_source *b, bitset_sink *out);
+
+// Performs AND NOT operation on two sources chunk by chunk, writing output 
+// to a sink. The sources must hold the same number of words. 
+//
+// PARAMS: 
+// a   - the left operand
+// b   - the right operand, used inverted
+// out - the sink to write to
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stream_andnot(bitset_source *a, bitset_source *b,
+        bitset_sink *out);
+
+// Counts the bits set to 1 in a source chunk by chunk. 
+//
+// PARAMS: 
+// src   - the source to count
+// count - the output number of bits set to 1
+//
+// RET: 
+// Zero on success, non-zero on error. 
+int bitset_stream_count(bitset_source *src, uint64_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
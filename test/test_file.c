@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// test_file.c
+// Tests of changing bitsets mapped from saved files. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <unistd.h>
+#include "bitset_file.h"
+
+#define LEN 1000
+
+// Fails the test if a condition does not hold. 
+#define CHECK(c) \
+    do { \
+        if (!(c)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, \
+                    __LINE__, #c); \
+            exit(1); \
+        } \
+    } while (0)
+
+static char path[] = "/tmp/test_file_XXXXXX";
+
+// Maps the saved file, checking it still holds the bits first saved. 
+//
+// PARAMS: 
+// b - the bitset to initialise
+static void map_saved(bitset *b) {
+    CHECK(bitset_map(b, path, true) == BITSET_GOOD);
+    CHECK(b->len == LEN && bitset_true_len(b) == 2);
+    CHECK(bitset_test_checked(b, 3) && bitset_test_checked(b, LEN - 1));
+}
+
+// Changes mapped bitsets in place, within their capacity and past it, and 
+// checks the file is left as saved. 
+static void test_mutate(void) {
+    bitset b;
+    map_saved(&b);
+    CHECK(bitset_set_checked(&b, 10) == BITSET_GOOD);
+    CHECK(bitset_flip_checked(&b, 3) == BITSET_GOOD);
+    CHECK(bitset_not(&b) == BITSET_GOOD);
+    CHECK(bitset_true_len(&b) == LEN - 2);
+    bitset_free(&b);
+
+    map_saved(&b);
+    CHECK(bitset_push_back(&b, true) == BITSET_GOOD);  // within capacity
+    CHECK(b.len == LEN + 1 && bitset_test_checked(&b, LEN));
+    bitset_free(&b);
+
+    map_saved(&b);
+    CHECK(bitset_resize(&b, 100) == BITSET_GOOD);      // clears the tail
+    CHECK(bitset_true_len(&b) == 1);
+    bitset_unmap(&b);
+
+    map_saved(&b);
+    CHECK(bitset_resize(&b, 100 * LEN) == BITSET_GOOD);    // grows
+    CHECK(b.alloc == NULL && bitset_true_len(&b) == 2);
+    CHECK(bitset_set_checked(&b, 50 * LEN) == BITSET_GOOD);
+    bitset_free(&b);
+
+    map_saved(&b);
+    bitset_free(&b);
+}
+
+int main(void) {
+    bitset b;
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    close(fd);
+    CHECK(bitset_init(&b, LEN) == BITSET_GOOD);
+    bitset_set_checked(&b, 3);
+    bitset_set_checked(&b, LEN - 1);
+    CHECK(bitset_save(&b, path) == BITSET_GOOD);
+    bitset_free(&b);
+
+    test_mutate();
+    remove(path);
+    puts("test_file: ok");
+    return 0;
+}
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+// test_parallel.c
+// Stress tests of the bitset thread pool. 
+//
+// Date:   14/10/2026
+// Author: PotatoMaster101
+///////////////////////////////////////////////////////////////////////////////
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include "bitset_parallel.h"
+
+#define WORDS 200000
+#define ROUNDS 200
+#define THREADS 8
+#define CALLERS 4
+#define CALLS 50
+
+// Fails the test if a condition does not hold. 
+#define CHECK(c) \
+    do { \
+        if (!(c)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, \
+                    __LINE__, #c); \
+            exit(1); \
+        } \
+    } while (0)
+
+static bitset_pool *shared;
+
+// Initialises a bitset of WORDS words with every bit of its even words set. 
+//
+// PARAMS: 
+// b - the bitset to initialise
+static void init_even(bitset *b) {
+    CHECK(bitset_init(b, WORDS * BITSET_WORD_LEN) == BITSET_GOOD);
+    for (size_t k = 0; k < WORDS; k += 2)
+        b->bits[k] = UINT64_MAX;
+}
+
+// Runs a job on a pool as soon as it is created, before its workers have 
+// started waiting, then frees it. 
+static void test_run_at_once(void) {
+    bitset a, b;
+    init_even(&a);
+    init_even(&b);
+    for (int r = 0; r < ROUNDS; r++) {
+        bitset_pool *p;
+        CHECK(bitset_pool_init(&p, THREADS) == BITSET_GOOD);
+        CHECK(bitset_par_and(p, &a, &b) == BITSET_GOOD);
+        bitset_pool_free(p);
+    }
+    CHECK(bitset_true_len(&a) == WORDS / 2 * BITSET_WORD_LEN);
+    bitset_free(&a);
+    bitset_free(&b);
+}
+
+// Flips a bitset of its own on the shared pool, checking every count. 
+//
+// PARAMS: 
+// arg - unused
+//
+// RET: 
+// Always NULL. 
+static void *caller(void *arg) {
+    (void)arg;
+    bitset a;
+    init_even(&a);
+    for (int i = 0; i < CALLS; i++) {
+        CHECK(bitset_par_not(shared, &a) == BITSET_GOOD);
+        CHECK(bitset_par_true_len(shared, &a) == WORDS / 2 * BITSET_WORD_LEN);
+    }
+    bitset_free(&a);
+    return NULL;
+}
+
+// Runs jobs from several threads on one pool at once. 
+static void test_callers(void) {
+    pthread_t t[CALLERS];
+    CHECK(bitset_pool_init(&shared, THREADS) == BITSET_GOOD);
+    for (int i = 0; i < CALLERS; i++)
+        CHECK(pthread_create(&t[i], NULL, caller, NULL) == 0);
+    for (int i = 0; i < CALLERS; i++)
+        pthread_join(t[i], NULL);
+    bitset_pool_free(shared);
+}
+
+int main(void) {
+    test_run_at_once();
+    test_callers();
+    puts("test_parallel: ok");
+    return 0;
+}